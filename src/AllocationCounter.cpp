@@ -0,0 +1,52 @@
+#include "AllocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Trivially constructed, so touching it from operator new cannot allocate
+thread_local uint64_t threadAllocations = 0;
+// Constant-initialized, so it is ready before any static constructor allocates
+std::atomic<uint64_t> processAllocations{0};
+
+void countAllocation() {
+    ++threadAllocations;
+    processAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+}
+
+namespace allocs {
+
+uint64_t count() {
+    return threadAllocations;
+}
+
+uint64_t total() {
+    return processAllocations.load(std::memory_order_relaxed);
+}
+
+} // namespace allocs
+
+void* operator new(std::size_t size) {
+    countAllocation();
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    countAllocation();
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations by replacing the global operator new. The
+// replacement is only linked into tetris_bench, and into every target when
+// configured with -DTETRIS_COUNT_ALLOCS=ON, in which case the game and
+// tetris-sim report any allocation made after warm-up.
+namespace allocs {
+
+#ifdef TETRIS_COUNT_ALLOCS
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+// Allocations made so far by the calling thread. Per thread, so worker
+// threads do not contend on a shared counter or see each other's.
+uint64_t count();
+// Allocations made so far by every thread, for work that a thread pool
+// spreads over threads the caller cannot see
+uint64_t total();
+
+} // namespace allocs
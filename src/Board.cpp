@@ -1,56 +1,182 @@
 #include "Board.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 
-Board::Board() : grid_(HEIGHT + HIDDEN_ROWS, std::vector<int>(WIDTH, 0)) {}
+namespace {
+
+// Per thread so boards in simulator workers never contend on it. Each
+// thread counts in its own range of stamps, so a board that is mutated on
+// different threads over time (MultiGame workers) still never repeats one.
+std::atomic<uint64_t> nextThreadRange{1};
+thread_local uint64_t generationCounter = nextThreadRange.fetch_add(1, std::memory_order_relaxed) << 40;
+
+} // namespace
+
+Board::Board() {
+    clear();
+}
 
 void Board::clear() {
-    for (auto& row : grid_) {
-        std::fill(row.begin(), row.end(), 0);
+    rows_.fill(0);
+    columns_.fill(0);
+    for (auto& row : colors_) {
+        row.fill(0);
     }
+    touch();
 }
 
 int Board::getCell(int x, int y) const {
     if (!isValidPosition(x, y)) return -1;
-    return grid_[y][x];
+    return colors_[y][x];
 }
 
 void Board::setCell(int x, int y, int value) {
-    if (isValidPosition(x, y)) {
-        grid_[y][x] = value;
+    if (!isValidPosition(x, y)) return;
+    
+    if (value != 0) {
+        rows_[y] |= static_cast<uint16_t>(1u << x);
+        columns_[x] |= 1u << y;
+    } else {
+        rows_[y] &= static_cast<uint16_t>(~(1u << x));
+        columns_[x] &= ~(1u << y);
+    }
+    colors_[y][x] = static_cast<uint8_t>(value);
+    touch();
+}
+
+void Board::setRow(int y, const std::array<uint8_t, WIDTH>& colors) {
+    uint16_t bits = 0;
+    for (int x = 0; x < WIDTH; ++x) {
+        uint32_t filled = colors[x] != 0;
+        bits |= static_cast<uint16_t>(filled << x);
+        columns_[x] = (columns_[x] & ~(1u << y)) | (filled << y);
     }
+    rows_[y] = bits;
+    colors_[y] = colors;
+    touch();
 }
 
 bool Board::isOccupied(int x, int y) const {
-    if (x < 0 || x >= WIDTH || y >= HEIGHT + HIDDEN_ROWS) return true;
+    if (x < 0 || x >= WIDTH || y >= TOTAL_ROWS) return true;
     if (y < 0) return false;
-    return grid_[y][x] != 0;
+    return (rows_[y] >> x) & 1u;
 }
 
 bool Board::isValidPosition(int x, int y) const {
-    return x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT + HIDDEN_ROWS;
+    return x >= 0 && x < WIDTH && y >= 0 && y < TOTAL_ROWS;
 }
 
-int Board::clearLines() {
-    int linesCleared = 0;
-    for (int y = HEIGHT + HIDDEN_ROWS - 1; y >= 0; --y) {
-        if (isLineComplete(y)) {
-            removeLine(y);
-            ++linesCleared;
-            ++y; // Check same row again since we shifted down
+void Board::place(const PieceMask& mask, int x, int y, int color) {
+    for (int by = mask.minY; by <= mask.maxY; ++by) {
+        int row = y + by;
+        if (row < 0 || row >= TOTAL_ROWS) continue;
+        
+        uint32_t bits = (static_cast<uint32_t>(mask.rows[by]) << (x + 4)) >> 4;
+        bits &= FULL_ROW;
+        rows_[row] |= static_cast<uint16_t>(bits);
+        for (int bx = 0; bits != 0; ++bx, bits >>= 1) {
+            if (bits & 1u) {
+                colors_[row][bx] = static_cast<uint8_t>(color);
+                columns_[bx] |= 1u << row;
+            }
         }
     }
-    return linesCleared;
+    touch();
 }
 
-bool Board::isLineComplete(int y) const {
-    for (int x = 0; x < WIDTH; ++x) {
-        if (grid_[y][x] == 0) return false;
+int Board::clearLines() {
+    // Compact surviving rows towards the bottom in a single pass. The write
+    // index only advances past rows that are kept, so full rows are simply
+    // overwritten by the rows above them.
+    int write = TOTAL_ROWS - 1;
+    uint32_t cleared = 0;
+    for (int y = TOTAL_ROWS - 1; y >= 0; --y) {
+        int keep = rows_[y] != FULL_ROW;
+        cleared |= static_cast<uint32_t>(!keep) << y;
+        rows_[write] = rows_[y];
+        colors_[write] = colors_[y];
+        write -= keep;
     }
-    return true;
+    
+    int linesCleared = write + 1;
+    if (linesCleared == 0) return 0;
+    
+    for (int y = 0; y < linesCleared; ++y) {
+        rows_[y] = 0;
+        colors_[y].fill(0);
+    }
+    removeRowsFromColumns(cleared);
+    touch();
+    return linesCleared;
 }
 
 void Board::removeLine(int y) {
     for (int row = y; row > 0; --row) {
-        grid_[row] = grid_[row - 1];
+        rows_[row] = rows_[row - 1];
+        colors_[row] = colors_[row - 1];
+    }
+    rows_[0] = 0;
+    colors_[0].fill(0);
+    removeRowsFromColumns(1u << y);
+    touch();
+}
+
+bool Board::addGarbage(int lines, int hole) {
+    lines = std::min(lines, TOTAL_ROWS);
+    bool overflow = false;
+    for (int y = 0; y < lines; ++y) {
+        overflow |= rows_[y] != 0;
+    }
+    
+    for (int y = 0; y + lines < TOTAL_ROWS; ++y) {
+        rows_[y] = rows_[y + lines];
+        colors_[y] = colors_[y + lines];
+    }
+    const uint16_t garbage = static_cast<uint16_t>(FULL_ROW & ~(1u << hole));
+    for (int y = TOTAL_ROWS - lines; y < TOTAL_ROWS; ++y) {
+        rows_[y] = garbage;
+        colors_[y].fill(static_cast<uint8_t>(GARBAGE_COLOR));
+        colors_[y][hole] = 0;
+    }
+    
+    // Every column moves up by lines; the new rows fill all but the hole
+    const uint32_t newRows = ((1u << lines) - 1) << (TOTAL_ROWS - lines);
+    for (int x = 0; x < WIDTH; ++x) {
+        columns_[x] = (columns_[x] >> lines) | (x == hole ? 0 : newRows);
+    }
+    touch();
+    return !overflow;
+}
+
+uint64_t Board::hash() const {
+    // The color plane is nonzero exactly where the rows have bits set, so
+    // it covers occupancy too. Mixed a word at a time, zero-padded at the end.
+    constexpr size_t BYTES = sizeof(colors_);
+    const uint8_t* bytes = colors_[0].data();
+    uint64_t h = 0x9e3779b97f4a7c15ull;
+    for (size_t offset = 0; offset < BYTES; offset += 8) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + offset, offset + 8 <= BYTES ? 8 : BYTES - offset);
+        h = (h ^ word) * 0xff51afd7ed558ccdull;
+        h ^= h >> 32;
+    }
+    return h;
+}
+
+void Board::touch() {
+    generation_ = ++generationCounter;
+}
+
+void Board::removeRowsFromColumns(uint32_t cleared) {
+    // Top to bottom: removing a row only moves the rows above it, so the
+    // indices of the cleared rows still to come stay valid
+    while (cleared != 0) {
+        int y = __builtin_ctz(cleared);
+        cleared &= cleared - 1;
+        uint32_t above = (1u << y) - 1;
+        for (uint32_t& column : columns_) {
+            column = (column & ~(above | (1u << y))) | ((column & above) << 1);
+        }
     }
-    grid_[0] = std::vector<int>(WIDTH, 0);
 }
@@ -1,13 +1,18 @@
 #pragma once
 
-#include <vector>
 #include <array>
+#include <cstdint>
+#include "PieceShapes.hpp"
 
 class Board {
 public:
     static constexpr int WIDTH = 10;
     static constexpr int HEIGHT = 20;
     static constexpr int HIDDEN_ROWS = 2;
+    static constexpr int TOTAL_ROWS = HEIGHT + HIDDEN_ROWS;
+    static constexpr uint16_t FULL_ROW = (1u << WIDTH) - 1;
+    // Cell color of garbage rows, after the seven piece colors
+    static constexpr int GARBAGE_COLOR = 8;
     
     Board();
     
@@ -18,9 +23,100 @@ public:
     bool isValidPosition(int x, int y) const;
     
     int clearLines();
-    bool isLineComplete(int y) const;
+    bool isLineComplete(int y) const { return rows_[y] == FULL_ROW; }
     void removeLine(int y);
+    // Push the stack up by lines and fill the rows opened at the bottom,
+    // leaving the cell in column hole empty. Returns false when blocks were
+    // pushed off the top of the board.
+    bool addGarbage(int lines, int hole);
+    
+    // Stamp taken from a per-thread counter on every change. Two boards
+    // with the same generation (copies, restored snapshots) hold the same
+    // cells, so a cache keyed on it never shows stale contents.
+    uint64_t generation() const { return generation_; }
+    
+    // Hash of the cells and their colors, the generation is left out so
+    // equal boards hash alike however they were reached
+    uint64_t hash() const;
+    
+    // Occupancy bitmask of row y: bit x is set when column x is filled
+    uint16_t getRow(int y) const { return rows_[y]; }
+    
+    // Colors of row y, 0 where the cell is empty
+    const std::array<uint8_t, WIDTH>& getRowColors(int y) const { return colors_[y]; }
+    // Overwrite row y from its colors; occupancy follows the nonzero cells
+    void setRow(int y, const std::array<uint8_t, WIDTH>& colors);
+    
+    // Kept alongside the rows on every change, so these are O(1). Height
+    // counts rows from the floor up to the topmost block, holes are the
+    // empty cells under it.
+    int columnHeight(int x) const {
+        return columns_[x] ? TOTAL_ROWS - __builtin_ctz(columns_[x]) : 0;
+    }
+    int columnHoles(int x) const { return columnHeight(x) - __builtin_popcount(columns_[x]); }
+    
+    // Collision test and lock for a piece mask whose 4x4 grid has its
+    // top-left corner at (x, y). Rows above the board never collide.
+    bool canPlace(const PieceMask& mask, int x, int y) const;
+    void place(const PieceMask& mask, int x, int y, int color);
+    
+    // Rows a piece at a valid position can fall before it rests, read off
+    // the column bitmasks under each column's lowest block
+    int dropDistance(const PieceMask& mask, int x, int y) const;
     
 private:
-    std::vector<std::vector<int>> grid_;
+    // Drop rows whose bit is set in cleared from the column bitmasks
+    void removeRowsFromColumns(uint32_t cleared);
+    void touch();
+    
+    std::array<uint16_t, TOTAL_ROWS> rows_;
+    // The same occupancy by column: bit y of columns_[x] is set when (x, y) is filled
+    std::array<uint32_t, WIDTH> columns_;
+    // Color plane, only read by the renderer
+    std::array<std::array<uint8_t, WIDTH>, TOTAL_ROWS> colors_;
+    uint64_t generation_;
 };
+
+// Read-only access to a board owned elsewhere, for code that only draws it
+class BoardView {
+public:
+    BoardView(const Board& board) : board_(&board) {}
+    
+    int getCell(int x, int y) const { return board_->getCell(x, y); }
+    uint16_t getRow(int y) const { return board_->getRow(y); }
+    uint64_t generation() const { return board_->generation(); }
+    
+private:
+    const Board* board_;
+};
+
+inline bool Board::canPlace(const PieceMask& mask, int x, int y) const {
+    if (x + mask.minX < 0 || x + mask.maxX >= WIDTH || y + mask.maxY >= TOTAL_ROWS) {
+        return false;
+    }
+    
+    // x is at least -3 once the bounds check passes, so shifting through a
+    // 4-bit pad keeps the shift amount non-negative without branching.
+    uint32_t hit = 0;
+    for (int by = mask.minY; by <= mask.maxY; ++by) {
+        int row = y + by;
+        if (row < 0) continue;
+        hit |= rows_[row] & ((static_cast<uint32_t>(mask.rows[by]) << (x + 4)) >> 4);
+    }
+    return hit == 0;
+}
+
+inline int Board::dropDistance(const PieceMask& mask, int x, int y) const {
+    int distance = 2 * TOTAL_ROWS;
+    for (int bx = mask.minX; bx <= mask.maxX; ++bx) {
+        // Obstacles from the row under this column's lowest block down,
+        // with the floor as a block at TOTAL_ROWS. Pieces poke at most four
+        // rows above the board, so a 64-bit shift covers both directions.
+        uint64_t below = static_cast<uint64_t>(columns_[x + bx]) | (uint64_t(1) << TOTAL_ROWS);
+        int start = y + mask.bottom[bx] + 1;
+        below = start >= 0 ? below >> start : below << -start;
+        int gap = __builtin_ctzll(below);
+        if (gap < distance) distance = gap;
+    }
+    return distance;
+}
@@ -0,0 +1,124 @@
+#include "Bot.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// Name and member of each weight, in file order
+struct WeightField {
+    const char* name;
+    double BotWeights::*value;
+};
+
+constexpr WeightField WEIGHT_FIELDS[] = {
+    {"height", &BotWeights::height},
+    {"holes", &BotWeights::holes},
+    {"bumpiness", &BotWeights::bumpiness},
+    {"wells", &BotWeights::wells},
+    {"lines", &BotWeights::lines},
+};
+
+} // namespace
+
+bool saveWeights(const std::string& path, const BotWeights& weights) {
+    std::ofstream out(path);
+    out.precision(17);
+    for (const WeightField& field : WEIGHT_FIELDS) {
+        out << field.name << ' ' << weights.*field.value << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+bool loadWeights(const std::string& path, BotWeights& weights) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    BotWeights loaded = weights;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string name;
+        double value;
+        if (!(fields >> name) || name[0] == '#') continue;
+        if (!(fields >> value)) return false;
+
+        auto field = std::find_if(std::begin(WEIGHT_FIELDS), std::end(WEIGHT_FIELDS),
+                                  [&name](const WeightField& f) { return name == f.name; });
+        if (field == std::end(WEIGHT_FIELDS)) return false;
+        loaded.*field->value = value;
+    }
+    weights = loaded;
+    return true;
+}
+
+Bot::Bot(const BotConfig& config) : config_(config) {
+    beam_.reserve(config_.beamWidth);
+    children_.reserve(256);
+}
+
+double Bot::evaluate(const Board& board, int linesCleared) const {
+    std::array<int, Board::WIDTH> heights;
+    int holes = 0;
+    for (int x = 0; x < Board::WIDTH; ++x) {
+        heights[x] = board.columnHeight(x);
+        holes += board.columnHoles(x);
+    }
+
+    int aggregateHeight = 0;
+    int bumpiness = 0;
+    int wells = 0;
+    for (int x = 0; x < Board::WIDTH; ++x) {
+        aggregateHeight += heights[x];
+        if (x + 1 < Board::WIDTH) bumpiness += std::abs(heights[x] - heights[x + 1]);
+
+        int left = x > 0 ? heights[x - 1] : Board::TOTAL_ROWS;
+        int right = x + 1 < Board::WIDTH ? heights[x + 1] : Board::TOTAL_ROWS;
+        int depth = std::min(left, right) - heights[x];
+        if (depth > 0) wells += depth;
+    }
+
+    const BotWeights& w = config_.weights;
+    return w.height * aggregateHeight + w.holes * holes + w.bumpiness * bumpiness +
+           w.wells * wells + w.lines * linesCleared;
+}
+
+void Bot::expand(const Node& parent, const Piece& piece, bool root) {
+    const std::vector<Piece>& placements = moveGen_.findPlacements(parent.board, piece);
+    for (const Piece& placement : placements) {
+        Node child{parent.board, root ? placement : parent.first, parent.lines, 0.0};
+        child.board.place(placement.getMask(), placement.getX(), placement.getY(), placement.getColor());
+        child.lines += child.board.clearLines();
+        child.score = evaluate(child.board, child.lines);
+        children_.push_back(child);
+    }
+}
+
+Piece Bot::choose(const Board& board, const Piece* pieces, int count) {
+    int depth = std::min(config_.depth, count);
+    if (depth <= 0) return Piece();
+
+    beam_.clear();
+    beam_.push_back(Node{board, Piece(), 0, 0.0});
+
+    for (int level = 0; level < depth; ++level) {
+        children_.clear();
+        Piece spawn(pieces[level].getType());
+        for (const Node& node : beam_) {
+            // The current piece starts where it is, later ones at the spawn point
+            expand(node, level == 0 ? pieces[0] : spawn, level == 0);
+        }
+
+        // No placement for this piece tops out every line, so settle for
+        // the best line found at the previous level
+        if (children_.empty()) break;
+
+        size_t keep = std::min(children_.size(), static_cast<size_t>(config_.beamWidth));
+        std::partial_sort(children_.begin(), children_.begin() + keep, children_.end(),
+                          [](const Node& a, const Node& b) { return a.score > b.score; });
+        beam_.assign(children_.begin(), children_.begin() + keep);
+    }
+
+    return beam_.front().first;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Board.hpp"
+#include "MoveGen.hpp"
+#include "Piece.hpp"
+
+// Weights of the board evaluation. Higher evaluations are better, so
+// penalties are negative.
+struct BotWeights {
+    double height = -0.51;      // sum of column heights
+    double holes = -0.36;       // empty cells with a filled cell above
+    double bumpiness = -0.18;   // sum of height differences between neighbors
+    double wells = -0.10;       // depth of columns lower than both neighbors
+    double lines = 0.76;        // lines cleared by the placement
+};
+
+// Weights files are text, one "name value" pair per line with the names
+// above, e.g. "holes -0.36". Lines starting with # are comments and names
+// left out keep their defaults.
+bool saveWeights(const std::string& path, const BotWeights& weights);
+// False, leaving weights untouched, on a missing file or an unknown name
+bool loadWeights(const std::string& path, BotWeights& weights);
+
+struct BotConfig {
+    BotWeights weights;
+    int beamWidth = 4;          // boards kept per lookahead level
+    int depth = 2;              // pieces searched, including the current one
+};
+
+// Placement search: tries every reachable placement of the current piece,
+// then extends the best beamWidth boards with each known upcoming piece.
+class Bot {
+public:
+    explicit Bot(const BotConfig& config = BotConfig());
+
+    // Best final position for the first of pieces[0..count), using the rest
+    // as lookahead. Returns a piece of type NONE if nothing can be placed.
+    Piece choose(const Board& board, const Piece* pieces, int count);
+
+    double evaluate(const Board& board, int linesCleared) const;
+
+    MoveGenerator& moveGenerator() { return moveGen_; }
+    const BotConfig& config() const { return config_; }
+
+private:
+    struct Node {
+        Board board;
+        Piece first;        // placement of the current piece this line started with
+        int lines;
+        double score;
+    };
+
+    void expand(const Node& parent, const Piece& piece, bool root);
+
+    BotConfig config_;
+    MoveGenerator moveGen_;
+    std::vector<Node> beam_;
+    std::vector<Node> children_;
+};
@@ -0,0 +1,85 @@
+#include "FrameStats.hpp"
+#include <algorithm>
+#include <limits>
+
+FrameStats::FrameStats()
+    : frameStart_(Clock::now())
+    , lastMark_(frameStart_)
+    , current_()
+    , samples_()
+    , frames_(0) {}
+
+uint32_t FrameStats::micros(Clock::duration duration) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    return static_cast<uint32_t>(std::min<long long>(us, std::numeric_limits<uint32_t>::max()));
+}
+
+void FrameStats::beginFrame() {
+    frameStart_ = Clock::now();
+    lastMark_ = frameStart_;
+    current_.fill(0);
+}
+
+void FrameStats::mark(Phase phase) {
+    Clock::time_point now = Clock::now();
+    current_[phase] += micros(now - lastMark_);
+    lastMark_ = now;
+}
+
+void FrameStats::endFrame(int ticks) {
+    current_[FRAME] = micros(Clock::now() - frameStart_);
+    
+    int slot = static_cast<int>(frames_ % WINDOW);
+    for (int phase = 0; phase <= FRAME; ++phase) {
+        samples_[phase][slot] = current_[phase];
+    }
+    
+    if (csv_.is_open()) {
+        csv_ << frames_ << ',' << ticks;
+        for (uint32_t us : current_) {
+            csv_ << ',' << us;
+        }
+        csv_ << '\n';
+    }
+    ++frames_;
+}
+
+FrameStats::Summary FrameStats::summary(int phase) const {
+    Summary result;
+    int count = static_cast<int>(std::min<uint64_t>(frames_, WINDOW));
+    if (count == 0) return result;
+    
+    // Selection on a stack copy, cheap enough to run every frame
+    std::array<uint32_t, WINDOW> sorted = samples_[phase];
+    auto end = sorted.begin() + count;
+    auto p99 = sorted.begin() + (count - 1) * 99 / 100;
+    auto p50 = sorted.begin() + (count - 1) / 2;
+    std::nth_element(sorted.begin(), p99, end);
+    std::nth_element(sorted.begin(), p50, p99);
+    result.p50 = *p50;
+    result.p99 = *p99;
+    result.max = *std::max_element(p99, end);
+    return result;
+}
+
+bool FrameStats::openCsv(const std::string& path) {
+    csv_.open(path);
+    if (!csv_) return false;
+    
+    csv_ << "frame,ticks";
+    for (int phase = 0; phase <= FRAME; ++phase) {
+        csv_ << ',' << phaseName(phase) << "_us";
+    }
+    csv_ << '\n';
+    return true;
+}
+
+const char* FrameStats::phaseName(int phase) {
+    switch (phase) {
+        case INPUT:   return "input";
+        case UPDATE:  return "update";
+        case RENDER:  return "render";
+        case PRESENT: return "present";
+        default:      return "frame";
+    }
+}
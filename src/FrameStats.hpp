@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Where the main loop spends its time. Each frame is cut into phases by
+// mark(), the last WINDOW frames are kept for percentiles, and every frame
+// can be streamed to a CSV file for offline analysis.
+class FrameStats {
+public:
+    enum Phase {
+        INPUT,      // draining and applying input events
+        UPDATE,     // fixed-step logic ticks
+        RENDER,     // building and submitting draw calls
+        PRESENT,    // swap, including any wait for vsync
+        PHASE_COUNT
+    };
+    // Index of the whole frame, start to start, in summary()
+    static constexpr int FRAME = PHASE_COUNT;
+    // Frames the percentiles cover, a little over 4 seconds at 60 Hz
+    static constexpr int WINDOW = 256;
+
+    // Microseconds over the window
+    struct Summary {
+        uint32_t p50 = 0;
+        uint32_t p99 = 0;
+        uint32_t max = 0;
+    };
+
+    FrameStats();
+
+    void beginFrame();
+    // Charge the time since the previous mark (or beginFrame) to phase
+    void mark(Phase phase);
+    // Close the frame that ran ticks logic ticks
+    void endFrame(int ticks);
+
+    // Percentiles of a phase, or of whole frames with FRAME
+    Summary summary(int phase) const;
+    uint64_t frames() const { return frames_; }
+
+    // Append one line per frame from now on; false if path cannot be opened
+    bool openCsv(const std::string& path);
+
+    static const char* phaseName(int phase);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static uint32_t micros(Clock::duration duration);
+
+    Clock::time_point frameStart_;
+    Clock::time_point lastMark_;
+    // The frame being measured, then a ring of the last WINDOW frames
+    std::array<uint32_t, PHASE_COUNT + 1> current_;
+    std::array<std::array<uint32_t, WINDOW>, PHASE_COUNT + 1> samples_;
+    uint64_t frames_;
+
+    std::ofstream csv_;
+};
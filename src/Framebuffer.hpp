@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// In-memory RGBA image. Pixels are packed as 0xAABBGGRR, which is R, G, B, A
+// byte order on little-endian hosts; the file writers unpack explicitly.
+class Framebuffer {
+public:
+    Framebuffer(int width, int height);
+
+    static constexpr uint32_t pack(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+        return uint32_t(r) | (uint32_t(g) << 8) | (uint32_t(b) << 16) | (uint32_t(a) << 24);
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    uint32_t* row(int y) { return &pixels_[static_cast<size_t>(y) * width_]; }
+    const uint32_t* row(int y) const { return &pixels_[static_cast<size_t>(y) * width_]; }
+    uint32_t pixel(int x, int y) const { return row(y)[x]; }
+
+    void fill(uint32_t color);
+    // Rectangles are clipped to the image. fillRect ignores the alpha of
+    // color, blendRect mixes color over what is there by its alpha.
+    void fillRect(int x, int y, int w, int h, uint32_t color);
+    void blendRect(int x, int y, int w, int h, uint32_t color);
+    // Opaque copy of all of source with its top-left corner at (x, y)
+    void blit(const Framebuffer& source, int x, int y);
+
+    // Box-filtered copy at 1/factor of the size, for thumbnails
+    Framebuffer downscaled(int factor) const;
+
+    // Binary PPM (RGB, alpha dropped) and uncompressed RGBA PNG
+    bool savePPM(const std::string& path) const;
+    bool savePNG(const std::string& path) const;
+
+private:
+    // Clip a rectangle to the image, false if nothing is left
+    bool clip(int& x, int& y, int& w, int& h) const;
+
+    int width_;
+    int height_;
+    std::vector<uint32_t> pixels_;
+};
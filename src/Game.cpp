@@ -1,21 +1,37 @@
 #include "Game.hpp"
+#include "AllocationCounter.hpp"
 #include "Renderer.hpp"
 #include "InputHandler.hpp"
-#include "Board.hpp"
-#include "Piece.hpp"
+#include "Policy.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
 #include <SDL2/SDL.h>
 #include <algorithm>
+#include <iostream>
+#include <random>
 
 Game::Game()
     : window_(nullptr)
     , running_(false)
-    , state_(GameState::PLAYING)
-    , board_(Board::HEIGHT + Board::HIDDEN_ROWS, std::vector<int>(Board::WIDTH, 0))
-    , score_(0)
-    , level_(1)
-    , linesCleared_(0)
-    , fallTimer_(0.0f)
-    , fallSpeed_(INITIAL_FALL_SPEED) {}
+    , state_()
+    , tickAccumulator_(0)
+    , counterFrequency_(1)
+    , vsync_(true)
+    , demoMode_(false)
+    , randomizer_(Randomizer::UNIFORM)
+    , recording_(false)
+    , replayFinished_(false)
+    , rewindHeld_(false)
+    , nextRewindTime_(0)
+    , wallBoards_(0)
+    , versus_(false)
+    , wallPaused_(false)
+    , netplayEnabled_(false)
+    , netInputHead_(0)
+    , netInputCount_(0)
+    , showStats_(false)
+    , tracePath_("tetris.trace.json")
+    , steadyAllocations_(0) {}
 
 Game::~Game() {
     shutdown();
@@ -28,34 +44,84 @@ bool Game::initialize() {
     
     window_ = SDL_CreateWindow("Tetris",
                               SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                              600, 700, SDL_WINDOW_SHOWN);
+                              Renderer::WINDOW_WIDTH, Renderer::WINDOW_HEIGHT, SDL_WINDOW_SHOWN);
     if (!window_) {
         return false;
     }
     
     renderer_ = std::make_unique<Renderer>();
-    if (!renderer_->initialize(window_)) {
+    if (!renderer_->initialize(window_, vsync_)) {
         return false;
     }
     
     inputHandler_ = std::make_unique<InputHandler>();
     
+    if (!statsCsvPath_.empty() && !frameStats_.openCsv(statsCsvPath_)) {
+        return false;
+    }
+    
     // Initialize game state
-    for (auto& row : board_) {
-        std::fill(row.begin(), row.end(), 0);
+    uint32_t seed = std::random_device{}();
+    if (netplayEnabled_ && !replayPlayer_) {
+        netLink_ = std::make_unique<UdpLink>();
+        if (!netLink_->open(netConfig_.localPort, netConfig_.remotePort, netConfig_.link)) {
+            std::cerr << "Cannot open UDP port " << netConfig_.localPort << std::endl;
+            return false;
+        }
+        netplay_ = std::make_unique<RollbackSession>(*netLink_, netConfig_);
+        std::string title = "Tetris - netplay, player " + std::to_string(netConfig_.localPlayer + 1);
+        SDL_SetWindowTitle(window_, title.c_str());
+    } else if (wallBoards_ > 0 && !replayPlayer_) {
+        wall_ = std::make_unique<MultiGame>(wallBoards_, seed, versus_, randomizer_);
+        resetWall();
+        if (!versus_) {
+            wallPool_ = std::make_unique<ThreadPool>();
+            wall_->setThreadPool(wallPool_.get());
+        }
+    } else if (replayPlayer_) {
+        replayPlayer_->start(state_);
+    } else {
+        rules::reset(state_, seed, randomizer_);
+        recording_ = !recordPath_.empty();
+        if (recording_) {
+            recorder_.begin(seed, state_.generator.randomizer());
+        }
+        rewind_.push(state_);
     }
-    nextPiece_ = std::make_unique<Piece>(Piece::createRandom());
-    spawnPiece();
+    autoplayer_ = createPolicy("bot", seed, bot_);
     
+    counterFrequency_ = SDL_GetPerformanceFrequency();
     running_ = true;
     return true;
 }
 
+void Game::setReplay(const Replay& replay) {
+    replay_ = replay;
+    replayPlayer_ = std::make_unique<ReplayPlayer>(replay_);
+    demoMode_ = false;
+}
+
 void Game::shutdown() {
+    if (recording_ && window_) {
+        saveReplay(recordPath_, recorder_.finish(state_));
+        recording_ = false;
+    }
+    
+    if (window_) {
+        writeTrace();
+        if (allocs::ENABLED) {
+            std::cout << steadyAllocations_ << " heap allocations after warm-up in "
+                      << frameStats_.frames() << " frames" << std::endl;
+        }
+    }
+    
     renderer_.reset();
     inputHandler_.reset();
-    currentPiece_.reset();
-    nextPiece_.reset();
+    autoplayer_.reset();
+    wall_.reset();
+    wallPool_.reset();
+    netplay_.reset();
+    netLink_.reset();
     
     if (window_) {
         SDL_DestroyWindow(window_);
@@ -66,286 +132,285 @@ void Game::shutdown() {
 }
 
 void Game::run() {
-    Uint32 lastTime = SDL_GetTicks();
+    Uint64 lastTime = SDL_GetPerformanceCounter();
     
     while (running_) {
-        Uint32 currentTime = SDL_GetTicks();
-        float deltaTime = (currentTime - lastTime) / 1000.0f;
+        TRACE_SCOPE("Game::frame");
+#ifdef TETRIS_COUNT_ALLOCS
+        // Every thread, so the wall's bots on pool workers count too
+        uint64_t allocationsBefore = allocs::total();
+#endif
+        frameStats_.beginFrame();
+        Uint64 currentTime = SDL_GetPerformanceCounter();
+        Uint64 elapsed = currentTime - lastTime;
         lastTime = currentTime;
         
         processInput();
+        frameStats_.mark(FrameStats::INPUT);
         
-        if (state_ == GameState::PLAYING) {
-            update(deltaTime);
+        int ticks = 0;
+        bool playing = wall_ ? wallRunning() : state_.status == GameStatus::PLAYING;
+        if (netplay_) {
+            // The match cannot be paused, and acks keep flowing after it ends
+            ticks = updateNetplay(elapsed);
+        } else if (playing || replayPlayer_) {
+            ticks = update(elapsed);
+        } else {
+            // Resuming from pause must not replay the time spent paused
+            tickAccumulator_ = 0;
         }
+        frameStats_.mark(FrameStats::UPDATE);
         
         render();
+        frameStats_.mark(FrameStats::RENDER);
         
-        // Cap at ~60 FPS
-        SDL_Delay(16);
+        // Paced by vsync when enabled, otherwise uncapped
+        renderer_->present();
+        frameStats_.mark(FrameStats::PRESENT);
+        frameStats_.endFrame(ticks);
+#ifdef TETRIS_COUNT_ALLOCS
+        if (frameStats_.frames() > ALLOC_WARMUP_FRAMES) {
+            steadyAllocations_ += allocs::total() - allocationsBefore;
+        }
+#endif
     }
 }
 
 void Game::processInput() {
+    TRACE_SCOPE("Game::processInput");
     inputHandler_->update();
     
     if (inputHandler_->shouldQuit()) {
         running_ = false;
         return;
     }
+    if (inputHandler_->renderTargetsLost() || inputHandler_->renderDeviceLost()) {
+        renderer_->restoreTextures(inputHandler_->renderDeviceLost());
+    }
     
-    InputAction action = inputHandler_->getAction();
+    // A replay drives the game by itself
+    if (replayPlayer_) return;
     
-    switch (action) {
-        case InputAction::PAUSE:
-            if (state_ == GameState::GAME_OVER) {
-                // Restart game
-                for (auto& row : board_) {
-                    std::fill(row.begin(), row.end(), 0);
-                }
-                score_ = 0;
-                level_ = 1;
-                linesCleared_ = 0;
-                fallSpeed_ = INITIAL_FALL_SPEED;
-                nextPiece_ = std::make_unique<Piece>(Piece::createRandom());
-                spawnPiece();
-                state_ = GameState::PLAYING;
-            } else {
-                state_ = (state_ == GameState::PAUSED) ? GameState::PLAYING : GameState::PAUSED;
-            }
-            inputHandler_->resetAction();
-            break;
-            
-        default:
-            break;
+    if (wall_) {
+        processWallInput();
+        return;
+    }
+    if (netplay_) {
+        processNetplayInput();
+        return;
     }
     
-    if (state_ != GameState::PLAYING) return;
+    // Apply every queued key in order so quick sequences are not collapsed
+    for (const InputEvent& event : inputHandler_->events()) {
+        if (event.action == InputAction::TOGGLE_DEMO) {
+            demoMode_ = !demoMode_;
+        } else if (event.action == InputAction::TOGGLE_STATS) {
+            showStats_ = !showStats_;
+        } else if (event.action == InputAction::DUMP_TRACE) {
+            writeTrace();
+        } else if (!demoMode_ || event.action == InputAction::PAUSE) {
+            applyAction(event.action);
+        }
+    }
     
-    // Handle piece movement
-    switch (action) {
-        case InputAction::MOVE_LEFT:
-            if (currentPiece_) {
-                currentPiece_->move(-1, 0);
-                if (!canPlacePiece(*currentPiece_)) {
-                    currentPiece_->move(1, 0);
-                }
-            }
-            break;
-            
-        case InputAction::MOVE_RIGHT:
-            if (currentPiece_) {
-                currentPiece_->move(1, 0);
-                if (!canPlacePiece(*currentPiece_)) {
-                    currentPiece_->move(-1, 0);
-                }
-            }
-            break;
-            
-        case InputAction::MOVE_DOWN:
-            if (currentPiece_) {
-                currentPiece_->move(0, 1);
-                if (!canPlacePiece(*currentPiece_)) {
-                    currentPiece_->move(0, -1);
-                    lockPiece();
-                }
-                score_ += 1;
-            }
-            break;
-            
-        case InputAction::ROTATE_CW:
-            if (currentPiece_) {
-                currentPiece_->rotate(1);
-                if (!canPlacePiece(*currentPiece_)) {
-                    // Try wall kicks
-                    currentPiece_->move(-1, 0);
-                    if (!canPlacePiece(*currentPiece_)) {
-                        currentPiece_->move(2, 0);
-                        if (!canPlacePiece(*currentPiece_)) {
-                            currentPiece_->move(-1, 0);
-                            currentPiece_->rotate(-1);
-                        }
-                    }
-                }
-            }
-            break;
-            
-        case InputAction::ROTATE_CCW:
-            if (currentPiece_) {
-                currentPiece_->rotate(-1);
-                if (!canPlacePiece(*currentPiece_)) {
-                    currentPiece_->move(-1, 0);
-                    if (!canPlacePiece(*currentPiece_)) {
-                        currentPiece_->move(2, 0);
-                        if (!canPlacePiece(*currentPiece_)) {
-                            currentPiece_->move(-1, 0);
-                            currentPiece_->rotate(1);
-                        }
-                    }
-                }
+    rewind();
+    
+    // Attract mode starts over when the bot tops out
+    if (demoMode_ && state_.status == GameStatus::GAME_OVER) {
+        applyAction(InputAction::PAUSE);
+    }
+}
+
+int Game::update(Uint64 elapsed) {
+    TRACE_SCOPE("Game::update");
+    const Uint64 maxBacklog = counterFrequency_ * MAX_TICKS_PER_FRAME;
+    tickAccumulator_ = std::min(tickAccumulator_ + elapsed * rules::TICKS_PER_SECOND, maxBacklog);
+    int ticks = 0;
+    while (tickAccumulator_ >= counterFrequency_) {
+        if (wall_) {
+            if (!wallRunning()) break;
+            wall_->tick();
+        } else if (replayPlayer_) {
+            // Recorded actions are applied at their tick, pauses included
+            if (!replayPlayer_->step(state_)) {
+                finishReplay();
+                break;
             }
-            break;
-            
-        case InputAction::HARD_DROP:
-            if (currentPiece_) {
-                while (canPlacePiece(*currentPiece_)) {
-                    currentPiece_->move(0, 1);
-                    score_ += 2;
-                }
-                currentPiece_->move(0, -1);
-                lockPiece();
+        } else if (state_.status == GameStatus::PLAYING) {
+            if (demoMode_) {
+                // The bot gets one action per tick, independent of frame rate
+                applyAction(autoplayer_->nextAction(state_));
             }
+            tick();
+        } else {
             break;
-            
-        default:
-            break;
+        }
+        tickAccumulator_ -= counterFrequency_;
+        ++ticks;
     }
+    return ticks;
 }
 
-void Game::update(float deltaTime) {
-    if (!currentPiece_) return;
-    
-    fallTimer_ += deltaTime;
-    
-    if (fallTimer_ >= fallSpeed_) {
-        fallTimer_ = 0.0f;
-        
-        currentPiece_->move(0, 1);
-        
-        if (!canPlacePiece(*currentPiece_)) {
-            currentPiece_->move(0, -1);
-            lockPiece();
+void Game::processWallInput() {
+    for (const InputEvent& event : inputHandler_->events()) {
+        if (event.action == InputAction::TOGGLE_STATS) {
+            showStats_ = !showStats_;
+        } else if (event.action == InputAction::DUMP_TRACE) {
+            writeTrace();
+        } else if (event.action == InputAction::PAUSE) {
+            // In versus P after a top-out starts the next match
+            bool matchOver = versus_ && !wallRunning() && !wallPaused_;
+            if (matchOver) {
+                resetWall();
+            } else {
+                wallPaused_ = !wallPaused_;
+            }
+        } else if (versus_ && wallRunning() && event.action != InputAction::TOGGLE_DEMO) {
+            // The player has board 0, the bot never takes keys
+            wall_->applyAction(0, event.action);
         }
     }
 }
 
-void Game::render() {
-    renderer_->clear();
-    
-    // Convert board to old format for renderer
-    Board board;
-    for (int y = 0; y < Board::HEIGHT + Board::HIDDEN_ROWS; ++y) {
-        for (int x = 0; x < Board::WIDTH; ++x) {
-            board.setCell(x, y, board_[y][x]);
+void Game::processNetplayInput() {
+    for (const InputEvent& event : inputHandler_->events()) {
+        if (event.action == InputAction::TOGGLE_STATS) {
+            showStats_ = !showStats_;
+        } else if (event.action == InputAction::DUMP_TRACE) {
+            writeTrace();
+        } else if (event.action == InputAction::TOGGLE_DEMO) {
+            demoMode_ = !demoMode_;
+        } else if (!demoMode_ && event.action != InputAction::PAUSE && netInputCount_ < NET_INPUT_QUEUE) {
+            netInputs_[(netInputHead_ + netInputCount_) % NET_INPUT_QUEUE] = event.action;
+            ++netInputCount_;
         }
     }
+}
+
+int Game::updateNetplay(Uint64 elapsed) {
+    TRACE_SCOPE("Game::updateNetplay");
+    netplay_->poll();
     
-    renderer_->drawBoard(board);
-    
-    // Draw ghost piece
-    if (currentPiece_ && state_ == GameState::PLAYING) {
-        Piece ghost = *currentPiece_;
-        while (canPlacePiece(ghost)) {
-            ghost.move(0, 1);
+    const Uint64 maxBacklog = counterFrequency_ * MAX_TICKS_PER_FRAME;
+    tickAccumulator_ = std::min(tickAccumulator_ + elapsed * rules::TICKS_PER_SECOND, maxBacklog);
+    int ticks = 0;
+    // While held back the time owed builds up and is caught up once the
+    // remote inputs arrive
+    while (tickAccumulator_ >= counterFrequency_ && netplay_->canAdvance()) {
+        InputAction action = InputAction::NONE;
+        if (demoMode_) {
+            // The bot plans on the board its input will land on, after the
+            // inputs still in the delay
+            const VersusState ahead = netplay_->scheduledState();
+            action = autoplayer_->nextAction(ahead.players[netplay_->localPlayer()]);
+        } else if (netInputCount_ > 0) {
+            action = netInputs_[netInputHead_];
+            netInputHead_ = (netInputHead_ + 1) % NET_INPUT_QUEUE;
+            --netInputCount_;
         }
-        ghost.move(0, -1);
-        renderer_->drawPiece(ghost, board, true);
-    }
-    
-    // Draw current piece
-    if (currentPiece_) {
-        renderer_->drawPiece(*currentPiece_, board, false);
+        netplay_->advance(action);
+        tickAccumulator_ -= counterFrequency_;
+        ++ticks;
     }
-    
-    // Draw next piece
-    if (nextPiece_) {
-        renderer_->drawNextPiece(*nextPiece_);
-    }
-    
-    // Draw UI
-    renderer_->drawUI(score_, level_, linesCleared_);
-    
-    // Draw overlays
-    if (state_ == GameState::GAME_OVER) {
-        renderer_->drawGameOver();
-    } else if (state_ == GameState::PAUSED) {
-        renderer_->drawPaused();
+    return ticks;
+}
+
+void Game::resetWall() {
+    // Every match gets fresh pieces, the same ones on both boards in versus
+    uint32_t seed = std::random_device{}();
+    for (int i = 0; i < wall_->size(); ++i) {
+        wall_->reset(i, versus_ ? seed : seed + static_cast<uint32_t>(i));
+        if (!versus_ || i > 0) {
+            wall_->setPolicy(i, createPolicy("bot", seed + static_cast<uint32_t>(i), bot_));
+        }
     }
-    
-    renderer_->present();
+    wall_->setAutoRestart(!versus_);
+    wallPaused_ = false;
+    tickAccumulator_ = 0;
 }
 
-void Game::spawnPiece() {
-    currentPiece_ = std::move(nextPiece_);
-    nextPiece_ = std::make_unique<Piece>(Piece::createRandom());
-    
-    // Check if game over
-    if (!canPlacePiece(*currentPiece_)) {
-        state_ = GameState::GAME_OVER;
+bool Game::wallRunning() const {
+    if (wallPaused_) return false;
+    // A spectator wall restarts its boards; a versus match ends at the first top-out
+    if (!versus_) return true;
+    for (int i = 0; i < wall_->size(); ++i) {
+        if (wall_->status(i) != GameStatus::PLAYING) return false;
     }
+    return true;
 }
 
-void Game::lockPiece() {
-    if (!currentPiece_) return;
+void Game::finishReplay() {
+    if (replayFinished_) return;
+    replayFinished_ = true;
     
-    auto blocks = currentPiece_->getBlocks();
-    for (const auto& [bx, by] : blocks) {
-        if (by >= 0 && by < Board::HEIGHT + Board::HIDDEN_ROWS &&
-            bx >= 0 && bx < Board::WIDTH) {
-            board_[by][bx] = currentPiece_->getColor();
+    bool verified = makeTrailer(state_, replayPlayer_->ticks()) == replay_.trailer;
+    SDL_SetWindowTitle(window_, verified ? "Tetris - replay verified" : "Tetris - replay MISMATCH");
+}
+
+void Game::rewind() {
+    bool held = inputHandler_->isRewindPressed() && !recording_ &&
+                state_.status != GameStatus::PAUSED;
+    if (held) {
+        Uint32 now = SDL_GetTicks();
+        if (!rewindHeld_ || SDL_TICKS_PASSED(now, nextRewindTime_)) {
+            // The first step goes back to the start of the current piece,
+            // each later one a piece further. After a top-out the newest
+            // entry is the finished game, so that one is skipped.
+            bool skipNewest = rewindHeld_ || state_.status == GameStatus::GAME_OVER;
+            rewind_.undo(state_, skipNewest ? 1 : 0);
+            tickAccumulator_ = 0;
+            nextRewindTime_ = now + REWIND_INTERVAL;
         }
     }
-    
-    // Clear lines
-    int lines = clearLines();
-    if (lines > 0) {
-        updateScore(lines);
-        updateLevel();
-    }
-    
-    spawnPiece();
+    rewindHeld_ = held;
 }
 
-int Game::clearLines() {
-    int linesCleared = 0;
-    int y = Board::HEIGHT + Board::HIDDEN_ROWS - 1;
-    while (y >= 0) {
-        bool complete = true;
-        for (int x = 0; x < Board::WIDTH; ++x) {
-            if (board_[y][x] == 0) {
-                complete = false;
-                break;
-            }
-        }
-        
-        if (complete) {
-            // Remove line
-            for (int row = y; row > 0; --row) {
-                board_[row] = board_[row - 1];
-            }
-            board_[0] = std::vector<int>(Board::WIDTH, 0);
-            ++linesCleared;
-            // Don't decrement y - check same row again since rows shifted down
-        } else {
-            --y;
-        }
+void Game::writeTrace() {
+    if (!trace::ENABLED) return;
+    if (trace::writeJson(tracePath_)) {
+        std::cout << "Trace written to " << tracePath_ << std::endl;
+    } else {
+        std::cerr << "Cannot write trace: " << tracePath_ << std::endl;
     }
-    return linesCleared;
 }
 
-void Game::updateScore(int lines) {
-    static const int lineScores[] = {0, 100, 300, 500, 800};
-    score_ += lineScores[lines] * level_;
-    linesCleared_ += lines;
+void Game::applyAction(InputAction action) {
+    if (recording_) recorder_.action(action);
+    bool restarting = action == InputAction::PAUSE && state_.status == GameStatus::GAME_OVER;
+    StepResult result = rules::applyAction(state_, action);
+    if (restarting) {
+        rewind_.clear();
+    }
+    if (restarting || result.piecesLocked > 0) {
+        rewind_.push(state_);
+    }
 }
 
-void Game::updateLevel() {
-    int newLevel = 1 + linesCleared_ / 10;
-    if (newLevel > level_) {
-        level_ = newLevel;
-        fallSpeed_ = std::max(0.1f, INITIAL_FALL_SPEED - (level_ - 1) * SPEED_INCREMENT);
+void Game::tick() {
+    if (recording_) recorder_.tick();
+    if (rules::tick(state_).piecesLocked > 0) {
+        rewind_.push(state_);
     }
 }
 
-bool Game::canPlacePiece(const Piece& piece) {
-    auto blocks = piece.getBlocks();
-    for (const auto& [bx, by] : blocks) {
-        if (bx < 0 || bx >= Board::WIDTH || by >= Board::HEIGHT + Board::HIDDEN_ROWS) {
-            return false;
-        }
-        if (by >= 0 && board_[by][bx] != 0) {
-            return false;
+void Game::render() {
+    renderer_->clear();
+    if (netplay_) {
+        renderer_->drawVersus(netplay_->state(), netplay_->localPlayer());
+    } else if (wall_) {
+        renderer_->drawWall(*wall_);
+        if (wallPaused_) {
+            renderer_->drawPaused();
         }
+    } else {
+        renderer_->drawGame(state_);
+    }
+    
+    if (demoMode_ && !wall_ && !netplay_) {
+        renderer_->drawDemo();
+    }
+    
+    if (showStats_) {
+        renderer_->drawFrameStats(frameStats_);
     }
-    return true;
 }
@@ -1,18 +1,21 @@
 #pragma once
 
 #include <SDL2/SDL.h>
-#include <vector>
+#include <array>
 #include <memory>
+#include <string>
+#include "Bot.hpp"
+#include "FrameStats.hpp"
+#include "MultiGame.hpp"
+#include "Netplay.hpp"
+#include "Replay.hpp"
+#include "Rewind.hpp"
+#include "Rules.hpp"
 
-class Piece;
 class Renderer;
 class InputHandler;
-
-enum class GameState {
-    PLAYING,
-    PAUSED,
-    GAME_OVER
-};
+class Policy;
+class ThreadPool;
 
 class Game {
 public:
@@ -23,39 +26,124 @@ public:
     void run();
     void shutdown();
     
+    // In demo mode the placement-search bot plays instead of the keyboard
+    void setDemoMode(bool enabled) { demoMode_ = enabled; }
+    // Without vsync frames are rendered as fast as possible; call before initialize()
+    void setVsync(bool enabled) { vsync_ = enabled; }
+    // Save the session as a replay to path when the game shuts down
+    void setRecordPath(const std::string& path) { recordPath_ = path; }
+    // Watch a recorded game in real time instead of playing; call before initialize()
+    void setReplay(const Replay& replay);
+    // Show the frame timing overlay from the start, F3 toggles it
+    void setShowStats(bool enabled) { showStats_ = enabled; }
+    // Stream per-frame phase timings to a CSV file; call before initialize()
+    void setStatsCsvPath(const std::string& path) { statsCsvPath_ = path; }
+    // Memory kept for hold-to-rewind history; call before initialize()
+    void setRewindCapacity(size_t bytes) { rewind_ = RewindBuffer(bytes); }
+    // Where F4 and shutdown write trace JSON; only TETRIS_TRACE builds record
+    void setTracePath(const std::string& path) { tracePath_ = path; }
+    // Watch boards bot games at once, each restarting when it tops out;
+    // call before initialize()
+    void setWall(int boards) { wallBoards_ = boards; versus_ = false; }
+    // Play board 0 against a bot on board 1, both dealt the same pieces;
+    // call before initialize()
+    void setVersus(bool enabled) { versus_ = enabled; wallBoards_ = enabled ? 2 : 0; }
+    // Play a versus match against another instance over UDP with rollback;
+    // call before initialize()
+    void setNetplay(const NetplayConfig& config) { netConfig_ = config; netplayEnabled_ = true; }
+    // Evaluation weights of every bot, e.g. from tetris-tune; call before initialize()
+    void setBotWeights(const BotWeights& weights) { bot_.weights = weights; }
+    // Piece order of the single-board game and the multi-board modes;
+    // call before initialize()
+    void setRandomizer(Randomizer randomizer) { randomizer_ = randomizer; }
+    
 private:
     void processInput();
-    void update(float deltaTime);
+    // Returns the number of logic ticks run
+    int update(Uint64 elapsed);
+    // Draws the frame, the caller presents it
     void render();
     
-    void spawnPiece();
-    void lockPiece();
-    int clearLines();
-    void updateScore(int linesCleared);
-    void updateLevel();
-    bool canPlacePiece(const Piece& piece);
+    // Every action and tick goes through these so it can be recorded
+    void applyAction(InputAction action);
+    void tick();
+    // Compare the end of a watched replay with its trailer
+    void finishReplay();
+    // Step back through the history while the rewind key is held
+    void rewind();
+    void writeTrace();
+    // Input, ticks and drawing when several boards are shown
+    void processWallInput();
+    void resetWall();
+    bool wallRunning() const;
+    void processNetplayInput();
+    int updateNetplay(Uint64 elapsed);
     
     SDL_Window* window_;
     bool running_;
-    GameState state_;
-    
-    static constexpr int BOARD_WIDTH = 10;
-    static constexpr int BOARD_HEIGHT = 20;
     
     std::unique_ptr<Renderer> renderer_;
     std::unique_ptr<InputHandler> inputHandler_;
     
-    std::vector<std::vector<int>> board_;
-    std::unique_ptr<Piece> currentPiece_;
-    std::unique_ptr<Piece> nextPiece_;
+    GameState state_;
+    // Elapsed performance-counter time scaled by TICKS_PER_SECOND, so one
+    // tick is exactly counterFrequency_ units and nothing is lost to rounding
+    Uint64 tickAccumulator_;
+    Uint64 counterFrequency_;
+    bool vsync_;
+    
+    std::unique_ptr<Policy> autoplayer_;
+    BotConfig bot_;
+    bool demoMode_;
+    // Uniform unless asked for, as the game always dealt
+    Randomizer randomizer_;
+    
+    std::string recordPath_;
+    // Only a recorded session stores actions, so play does not grow a buffer
+    bool recording_;
+    ReplayRecorder recorder_;
+    Replay replay_;
+    std::unique_ptr<ReplayPlayer> replayPlayer_;
+    bool replayFinished_;
+    
+    // One entry per locked piece. Rewinding would desync a recording, so it
+    // is off while recording or watching a replay.
+    RewindBuffer rewind_;
+    bool rewindHeld_;
+    Uint32 nextRewindTime_;
+    static constexpr Uint32 REWIND_INTERVAL = 100;
+    
+    // Multi-board modes. Recording and rewind cover only the single-board
+    // game, so both are off here.
+    int wallBoards_;
+    bool versus_;
+    bool wallPaused_;
+    std::unique_ptr<MultiGame> wall_;
+    // Spreads the bots of a large wall over the cores
+    std::unique_ptr<ThreadPool> wallPool_;
+    
+    // Netplay match. Keys wait here, one applied per tick, while the
+    // session is held back for the remote player.
+    bool netplayEnabled_;
+    NetplayConfig netConfig_;
+    std::unique_ptr<UdpLink> netLink_;
+    std::unique_ptr<RollbackSession> netplay_;
+    static constexpr int NET_INPUT_QUEUE = 16;
+    std::array<InputAction, NET_INPUT_QUEUE> netInputs_;
+    int netInputHead_;
+    int netInputCount_;
     
-    int score_;
-    int level_;
-    int linesCleared_;
+    FrameStats frameStats_;
+    bool showStats_;
+    std::string statsCsvPath_;
+    std::string tracePath_;
     
-    float fallTimer_;
-    float fallSpeed_;
+    // Heap allocations made by frames after warm-up, counted only in
+    // TETRIS_COUNT_ALLOCS builds
+    uint64_t steadyAllocations_;
+    static constexpr uint64_t ALLOC_WARMUP_FRAMES = 120;
     
-    static constexpr float INITIAL_FALL_SPEED = 1.0f;
-    static constexpr float SPEED_INCREMENT = 0.1f;
+    // After a stall (window drag, breakpoint) catch up at most this many
+    // ticks and drop the rest instead of fast-forwarding the game
+    static constexpr int MAX_TICKS_PER_FRAME = 10;
 };
@@ -0,0 +1,16 @@
+#pragma once
+
+enum class InputAction {
+    NONE,
+    MOVE_LEFT,
+    MOVE_RIGHT,
+    MOVE_DOWN,
+    ROTATE_CW,
+    ROTATE_CCW,
+    HARD_DROP,
+    PAUSE,
+    QUIT,
+    TOGGLE_DEMO,
+    TOGGLE_STATS,
+    DUMP_TRACE
+};
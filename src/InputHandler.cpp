@@ -1,16 +1,23 @@
 #include "InputHandler.hpp"
 
 InputHandler::InputHandler()
-    : currentAction_(InputAction::NONE)
-    , quitRequested_(false)
+    : quitRequested_(false)
+    , renderTargetsLost_(false)
+    , renderDeviceLost_(false)
     , leftPressed_(false)
     , rightPressed_(false)
     , downPressed_(false)
     , rotatePressed_(false)
-    , lastRepeatTime_(0) {}
+    , rewindPressed_(false)
+    , repeatAction_(InputAction::NONE)
+    , nextRepeatTime_(0) {
+    events_.reserve(32);
+}
 
 void InputHandler::update() {
-    currentAction_ = InputAction::NONE;
+    events_.clear();
+    renderTargetsLost_ = false;
+    renderDeviceLost_ = false;
     
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
@@ -19,40 +26,63 @@ void InputHandler::update() {
                 quitRequested_ = true;
                 break;
                 
+            case SDL_RENDER_TARGETS_RESET:
+                renderTargetsLost_ = true;
+                break;
+                
+            case SDL_RENDER_DEVICE_RESET:
+                renderDeviceLost_ = true;
+                break;
+                
             case SDL_KEYDOWN:
                 if (!event.key.repeat) {
+                    Uint32 time = event.key.timestamp;
+                    emitRepeats(time);
                     switch (event.key.keysym.sym) {
                         case SDLK_LEFT:
                         case SDLK_a:
                             leftPressed_ = true;
-                            currentAction_ = InputAction::MOVE_LEFT;
-                            lastRepeatTime_ = SDL_GetTicks();
+                            push(InputAction::MOVE_LEFT, time);
+                            startRepeat(InputAction::MOVE_LEFT, time);
                             break;
                         case SDLK_RIGHT:
                         case SDLK_d:
                             rightPressed_ = true;
-                            currentAction_ = InputAction::MOVE_RIGHT;
-                            lastRepeatTime_ = SDL_GetTicks();
+                            push(InputAction::MOVE_RIGHT, time);
+                            startRepeat(InputAction::MOVE_RIGHT, time);
                             break;
                         case SDLK_DOWN:
                         case SDLK_s:
                             downPressed_ = true;
-                            currentAction_ = InputAction::MOVE_DOWN;
+                            push(InputAction::MOVE_DOWN, time);
                             break;
                         case SDLK_UP:
                         case SDLK_w:
                         case SDLK_x:
                             rotatePressed_ = true;
-                            currentAction_ = InputAction::ROTATE_CW;
+                            push(InputAction::ROTATE_CW, time);
                             break;
                         case SDLK_z:
-                            currentAction_ = InputAction::ROTATE_CCW;
+                            push(InputAction::ROTATE_CCW, time);
                             break;
                         case SDLK_SPACE:
-                            currentAction_ = InputAction::HARD_DROP;
+                            push(InputAction::HARD_DROP, time);
                             break;
                         case SDLK_p:
-                            currentAction_ = InputAction::PAUSE;
+                            push(InputAction::PAUSE, time);
+                            break;
+                        case SDLK_b:
+                            push(InputAction::TOGGLE_DEMO, time);
+                            break;
+                        case SDLK_r:
+                            // Held rather than queued, the game steps back while it is down
+                            rewindPressed_ = true;
+                            break;
+                        case SDLK_F3:
+                            push(InputAction::TOGGLE_STATS, time);
+                            break;
+                        case SDLK_F4:
+                            push(InputAction::DUMP_TRACE, time);
                             break;
                         case SDLK_ESCAPE:
                             quitRequested_ = true;
@@ -61,15 +91,24 @@ void InputHandler::update() {
                 }
                 break;
                 
-            case SDL_KEYUP:
+            case SDL_KEYUP: {
+                Uint32 time = event.key.timestamp;
+                emitRepeats(time);
                 switch (event.key.keysym.sym) {
                     case SDLK_LEFT:
                     case SDLK_a:
                         leftPressed_ = false;
+                        if (repeatAction_ == InputAction::MOVE_LEFT) {
+                            // Fall back to the other direction if it is still held
+                            startRepeat(rightPressed_ ? InputAction::MOVE_RIGHT : InputAction::NONE, time);
+                        }
                         break;
                     case SDLK_RIGHT:
                     case SDLK_d:
                         rightPressed_ = false;
+                        if (repeatAction_ == InputAction::MOVE_RIGHT) {
+                            startRepeat(leftPressed_ ? InputAction::MOVE_LEFT : InputAction::NONE, time);
+                        }
                         break;
                     case SDLK_DOWN:
                     case SDLK_s:
@@ -80,33 +119,41 @@ void InputHandler::update() {
                     case SDLK_x:
                         rotatePressed_ = false;
                         break;
+                    case SDLK_r:
+                        rewindPressed_ = false;
+                        break;
                 }
                 break;
-        }
-    }
-    
-    // Handle auto-repeat for left/right
-    Uint32 currentTime = SDL_GetTicks();
-    if ((leftPressed_ || rightPressed_) && currentTime - lastRepeatTime_ > REPEAT_DELAY) {
-        if (currentTime - lastRepeatTime_ > REPEAT_INTERVAL) {
-            if (leftPressed_) {
-                currentAction_ = InputAction::MOVE_LEFT;
-            } else {
-                currentAction_ = InputAction::MOVE_RIGHT;
             }
-            lastRepeatTime_ = currentTime;
         }
     }
+    
+    // Repeats that came due since the last event
+    emitRepeats(SDL_GetTicks());
 }
 
 bool InputHandler::shouldQuit() const {
     return quitRequested_;
 }
 
-InputAction InputHandler::getAction() const {
-    return currentAction_;
+void InputHandler::push(InputAction action, Uint32 time) {
+    events_.push_back({action, time});
+}
+
+void InputHandler::emitRepeats(Uint32 time) {
+    if (repeatAction_ == InputAction::NONE) return;
+    
+    // Signed difference keeps the comparison right across timer wraparound
+    if (static_cast<Sint32>(time - nextRepeatTime_) < 0) return;
+    push(repeatAction_, nextRepeatTime_);
+    nextRepeatTime_ += REPEAT_INTERVAL;
+    // After a stall the piece moves once, not once per interval missed
+    if (static_cast<Sint32>(time - nextRepeatTime_) >= 0) {
+        nextRepeatTime_ = time + REPEAT_INTERVAL;
+    }
 }
 
-void InputHandler::resetAction() {
-    currentAction_ = InputAction::NONE;
+void InputHandler::startRepeat(InputAction direction, Uint32 time) {
+    repeatAction_ = direction;
+    nextRepeatTime_ = time + REPEAT_DELAY;
 }
@@ -1,45 +1,56 @@
 #pragma once
 
 #include <SDL2/SDL.h>
+#include <vector>
+#include "InputAction.hpp"
 
-enum class InputAction {
-    NONE,
-    MOVE_LEFT,
-    MOVE_RIGHT,
-    MOVE_DOWN,
-    ROTATE_CW,
-    ROTATE_CCW,
-    HARD_DROP,
-    PAUSE,
-    QUIT
+struct InputEvent {
+    InputAction action;
+    Uint32 time;    // SDL milliseconds when the key went down or the repeat fell due
 };
 
 class InputHandler {
 public:
     InputHandler();
     
+    // Drains SDL's queue into events(), replacing the previous batch
     void update();
     
     bool shouldQuit() const;
-    InputAction getAction() const;
+    // The renderer lost the contents of its target textures, or with the
+    // device every texture, during the last update
+    bool renderTargetsLost() const { return renderTargetsLost_; }
+    bool renderDeviceLost() const { return renderDeviceLost_; }
+    // Every action since the last update, oldest first, auto-repeats included
+    const std::vector<InputEvent>& events() const { return events_; }
     
     bool isLeftPressed() const { return leftPressed_; }
     bool isRightPressed() const { return rightPressed_; }
     bool isDownPressed() const { return downPressed_; }
     bool isRotatePressed() const { return rotatePressed_; }
-    
-    void resetAction();
+    bool isRewindPressed() const { return rewindPressed_; }
     
 private:
-    InputAction currentAction_;
+    void push(InputAction action, Uint32 time);
+    // Queue the left/right repeat that fell due before time, at most one
+    void emitRepeats(Uint32 time);
+    // Start DAS for a direction, or stop it with InputAction::NONE
+    void startRepeat(InputAction direction, Uint32 time);
+    
+    std::vector<InputEvent> events_;
     bool quitRequested_;
+    bool renderTargetsLost_;
+    bool renderDeviceLost_;
     
     bool leftPressed_;
     bool rightPressed_;
     bool downPressed_;
     bool rotatePressed_;
+    bool rewindPressed_;
     
-    Uint32 lastRepeatTime_;
+    // The most recently pressed held direction repeats
+    InputAction repeatAction_;
+    Uint32 nextRepeatTime_;
     static constexpr Uint32 REPEAT_DELAY = 150;
     static constexpr Uint32 REPEAT_INTERVAL = 50;
 };
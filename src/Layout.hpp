@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include "Board.hpp"
+
+// Screen layout and palette shared by the SDL renderer and the software
+// renderer, so both draw the same frame.
+namespace layout {
+
+constexpr int WINDOW_WIDTH = 600;
+constexpr int WINDOW_HEIGHT = 700;
+constexpr int CELL_SIZE = 30;
+constexpr int GRID_OFFSET_X = 50;
+constexpr int GRID_OFFSET_Y = 50;
+constexpr int PREVIEW_OFFSET_X = 400;
+constexpr int PREVIEW_OFFSET_Y = 100;
+
+struct Color {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+constexpr Color BACKGROUND = {20, 20, 20};
+constexpr Color BORDER = {100, 100, 100};
+constexpr Color PREVIEW_BOX = {80, 80, 80};
+constexpr Color GRID_LINE = {50, 50, 50};
+
+constexpr std::array<Color, 9> CELL_COLORS = {{
+    {128, 128, 128},  // 0: Empty (Gray)
+    {0, 255, 255},    // 1: I (Cyan)
+    {255, 255, 0},    // 2: O (Yellow)
+    {128, 0, 128},    // 3: T (Purple)
+    {0, 255, 0},      // 4: S (Green)
+    {255, 0, 0},      // 5: Z (Red)
+    {0, 0, 255},      // 6: J (Blue)
+    {255, 165, 0},    // 7: L (Orange)
+    {90, 90, 90}      // 8: Garbage (Dark gray)
+}};
+
+struct Label {
+    const char* text;
+    int x;
+    int y;
+};
+
+// Text that never changes, drawn once into the static background
+constexpr Label STATIC_LABELS[] = {
+    {"NEXT", PREVIEW_OFFSET_X + 35, PREVIEW_OFFSET_Y - 25},
+    {"CONTROLS:", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 260},
+    {"Left/Right: Move", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 285},
+    {"Down: Soft Drop", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 305},
+    {"Up/Z: Rotate", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 325},
+    {"Space: Hard Drop", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 345},
+    {"P: Pause", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 365},
+    {"B: Demo Mode", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 385},
+    {"F3: Frame Stats", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 405}
+};
+
+constexpr Label GAME_OVER_LABELS[] = {
+    {"GAME OVER", GRID_OFFSET_X + 60, 300},
+    {"Press P to restart", GRID_OFFSET_X + 50, 340}
+};
+
+constexpr Label PAUSED_LABELS[] = {
+    {"PAUSED", GRID_OFFSET_X + 80, 300},
+    {"Press P to resume", GRID_OFFSET_X + 40, 340}
+};
+
+// Score, level and lines rows of the side panel
+constexpr int SCORE_Y = PREVIEW_OFFSET_Y + 150;
+constexpr int LEVEL_Y = PREVIEW_OFFSET_Y + 180;
+constexpr int LINES_Y = PREVIEW_OFFSET_Y + 210;
+
+// Frame timing overlay, F3: a header and one row per phase plus the frame
+constexpr int STATS_X = GRID_OFFSET_X + 5;
+constexpr int STATS_Y = GRID_OFFSET_Y + 5;
+constexpr int STATS_WIDTH = 250;
+constexpr int STATS_ROW_HEIGHT = 20;
+constexpr int STATS_COLUMNS[] = {STATS_X + 8, STATS_X + 90, STATS_X + 145, STATS_X + 200};
+
+constexpr uint8_t OVERLAY_ALPHA = 200;
+constexpr uint8_t GHOST_FILL_ALPHA = 80;
+constexpr uint8_t GHOST_OUTLINE_ALPHA = 150;
+
+// Multi-board view: the boards in a grid, scaled to the largest cell size
+// at which all of them fit the window
+constexpr int WALL_MARGIN = 6;
+constexpr int WALL_LABEL_HEIGHT = 18;
+// Below this cell size the score line under each board is left out
+constexpr int WALL_MIN_LABEL_CELL = 12;
+constexpr Color WALL_BOARD = {35, 35, 35};
+// Pending garbage beside each versus board
+constexpr Color GARBAGE_METER = {220, 40, 40};
+constexpr int GARBAGE_METER_WIDTH = 4;
+
+struct WallLayout {
+    int columns;
+    int cellSize;
+    int pitchX;         // from one board's left edge to the next
+    int pitchY;
+    int originX;        // top-left of the first board
+    int originY;
+    bool labels;        // room for a score line under each board
+
+    int boardX(int index) const { return originX + (index % columns) * pitchX; }
+    int boardY(int index) const { return originY + (index / columns) * pitchY; }
+};
+
+constexpr WallLayout wallLayout(int boards, int width = WINDOW_WIDTH, int height = WINDOW_HEIGHT) {
+    constexpr int COLUMNS = Board::WIDTH;
+    constexpr int ROWS = Board::HEIGHT;
+    WallLayout best{1, 0, 0, 0, 0, 0, false};
+    for (int columns = 1; columns <= boards; ++columns) {
+        int rows = (boards + columns - 1) / columns;
+        int cellWide = (width / columns - WALL_MARGIN) / COLUMNS;
+        int cellLabeled = std::min(cellWide, (height / rows - WALL_MARGIN - WALL_LABEL_HEIGHT) / ROWS);
+        bool labels = cellLabeled >= WALL_MIN_LABEL_CELL;
+        int cell = labels ? cellLabeled : std::min(cellWide, (height / rows - WALL_MARGIN) / ROWS);
+        if (cell > best.cellSize) {
+            int pitchX = cell * COLUMNS + WALL_MARGIN;
+            int pitchY = cell * ROWS + WALL_MARGIN + (labels ? WALL_LABEL_HEIGHT : 0);
+            best = {columns, cell, pitchX, pitchY,
+                    (width - columns * pitchX + WALL_MARGIN) / 2,
+                    (height - rows * pitchY + WALL_MARGIN) / 2, labels};
+        }
+    }
+    return best;
+}
+
+} // namespace layout
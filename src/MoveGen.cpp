@@ -0,0 +1,175 @@
+#include "MoveGen.hpp"
+#include "Rules.hpp"
+#include <algorithm>
+
+namespace {
+
+// Lowest rotation index with the same shape, so that e.g. the two
+// horizontal I rotations, which only differ by a row offset, compare equal.
+using CanonicalTable = std::array<std::array<int8_t, 4>, 7>;
+
+constexpr CanonicalTable buildCanonicalRotations(const PieceMaskTable& masks) {
+    CanonicalTable canonical{};
+    for (int type = 0; type < 7; ++type) {
+        for (int rotation = 0; rotation < 4; ++rotation) {
+            canonical[type][rotation] = static_cast<int8_t>(rotation);
+            for (int other = 0; other < rotation; ++other) {
+                const PieceMask& a = masks[type][rotation];
+                const PieceMask& b = masks[type][other];
+                bool same = a.maxX - a.minX == b.maxX - b.minX && a.maxY - a.minY == b.maxY - b.minY;
+                for (int row = 0; same && row <= a.maxY - a.minY; ++row) {
+                    same = (a.rows[a.minY + row] >> a.minX) == (b.rows[b.minY + row] >> b.minX);
+                }
+                if (same) {
+                    canonical[type][rotation] = static_cast<int8_t>(other);
+                    break;
+                }
+            }
+        }
+    }
+    return canonical;
+}
+
+constexpr CanonicalTable CANONICAL_ROTATIONS = buildCanonicalRotations(PIECE_MASKS);
+
+// Rotations and shifts come before soft drop, so among equally short paths
+// the search prefers the one that lines the piece up near the top and
+// leaves the fall to a single hard drop.
+constexpr InputAction SEARCH_MOVES[] = {
+    InputAction::ROTATE_CW,
+    InputAction::ROTATE_CCW,
+    InputAction::MOVE_LEFT,
+    InputAction::MOVE_RIGHT,
+    InputAction::MOVE_DOWN
+};
+
+bool applyMove(const Board& board, Piece& piece, InputAction move, bool instantGravity) {
+    switch (move) {
+        case InputAction::MOVE_LEFT:  return rules::tryMove(board, piece, -1, 0);
+        case InputAction::MOVE_RIGHT: return rules::tryMove(board, piece, 1, 0);
+        case InputAction::MOVE_DOWN:  return rules::tryMove(board, piece, 0, 1);
+        // The rules only kick upwards under 20G
+        case InputAction::ROTATE_CW:  return rules::tryRotate(board, piece, 1, instantGravity);
+        case InputAction::ROTATE_CCW: return rules::tryRotate(board, piece, -1, instantGravity);
+        default:                      return false;
+    }
+}
+
+} // namespace
+
+MoveGenerator::MoveGenerator() : generation_(0), queueSize_(0), instantGravity_(false) {
+    stamp_.fill(0);
+    footprintStamp_.fill(0);
+    placements_.reserve(STATES);
+}
+
+bool MoveGenerator::inSearchSpace(const Piece& piece) {
+    return piece.getType() != PieceType::NONE && piece.getY() >= 0 && piece.getY() < Board::TOTAL_ROWS &&
+           piece.getX() >= -3 && piece.getX() < Board::WIDTH;
+}
+
+int MoveGenerator::stateIndex(const Piece& piece) {
+    return (piece.getRotation() * Board::TOTAL_ROWS + piece.getY()) * COLUMNS + piece.getX() + 3;
+}
+
+Piece MoveGenerator::stateFromIndex(PieceType type, int index) {
+    Piece piece(type);
+    piece.setX(index % COLUMNS - 3);
+    piece.setY(index / COLUMNS % Board::TOTAL_ROWS);
+    piece.setRotation(index / (COLUMNS * Board::TOTAL_ROWS));
+    return piece;
+}
+
+uint32_t MoveGenerator::footprintKey(const Piece& piece) {
+    const PieceMask& mask = piece.getMask();
+    int rotation = CANONICAL_ROTATIONS[static_cast<int>(piece.getType())][piece.getRotation()];
+    int top = piece.getY() + mask.minY;
+    int left = piece.getX() + mask.minX;
+    return static_cast<uint32_t>((rotation * Board::TOTAL_ROWS + top) * COLUMNS + left);
+}
+
+void MoveGenerator::search(const Board& board, const Piece& piece, uint32_t stopAtFootprint) {
+    if (++generation_ == 0) {
+        // Stamp counter wrapped, forget every stale mark
+        stamp_.fill(0);
+        footprintStamp_.fill(0);
+        generation_ = 1;
+    }
+
+    Piece start = piece;
+    if (instantGravity_) start.move(0, rules::dropDistance(board, start));
+
+    int root = stateIndex(start);
+    stamp_[root] = generation_;
+    parent_[root] = -1;
+    queue_[0] = static_cast<int16_t>(root);
+    int head = 0;
+    queueSize_ = 1;
+
+    while (head < queueSize_) {
+        int index = queue_[head++];
+        Piece from = stateFromIndex(piece.getType(), index);
+        if (footprintKey(from) == stopAtFootprint) break;
+
+        for (InputAction move : SEARCH_MOVES) {
+            Piece to = from;
+            if (!applyMove(board, to, move, instantGravity_)) continue;
+            if (instantGravity_) to.move(0, rules::dropDistance(board, to));
+
+            int next = stateIndex(to);
+            if (visited(next)) continue;
+            stamp_[next] = generation_;
+            parent_[next] = static_cast<int16_t>(index);
+            move_[next] = move;
+            queue_[queueSize_++] = static_cast<int16_t>(next);
+        }
+    }
+}
+
+const std::vector<Piece>& MoveGenerator::findPlacements(const Board& board, const Piece& piece) {
+    placements_.clear();
+    if (!inSearchSpace(piece) || !rules::canPlace(board, piece)) return placements_;
+
+    search(board, piece, NO_FOOTPRINT);
+
+    for (int i = 0; i < queueSize_; ++i) {
+        Piece candidate = stateFromIndex(piece.getType(), queue_[i]);
+        if (board.canPlace(candidate.getMask(), candidate.getX(), candidate.getY() + 1)) continue;
+
+        uint32_t key = footprintKey(candidate);
+        if (footprintStamp_[key] == generation_) continue;
+        footprintStamp_[key] = generation_;
+        placements_.push_back(candidate);
+    }
+    return placements_;
+}
+
+bool MoveGenerator::findPath(const Board& board, const Piece& piece, const Piece& target,
+                             std::vector<InputAction>& path) {
+    path.clear();
+    if (!inSearchSpace(piece) || !rules::canPlace(board, piece)) return false;
+
+    uint32_t targetKey = footprintKey(target);
+    search(board, piece, targetKey);
+
+    int found = -1;
+    for (int i = 0; i < queueSize_; ++i) {
+        if (footprintKey(stateFromIndex(piece.getType(), queue_[i])) == targetKey) {
+            found = queue_[i];
+            break;
+        }
+    }
+    if (found < 0) return false;
+
+    for (int index = found; parent_[index] >= 0; index = parent_[index]) {
+        path.push_back(move_[index]);
+    }
+    std::reverse(path.begin(), path.end());
+
+    // Whatever falls straight down at the end is a single hard drop
+    while (!path.empty() && path.back() == InputAction::MOVE_DOWN) {
+        path.pop_back();
+    }
+    path.push_back(InputAction::HARD_DROP);
+    return true;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "Board.hpp"
+#include "InputAction.hpp"
+#include "Piece.hpp"
+
+// Enumerates where a piece can come to rest by breadth-first search over
+// the same moves a player has: shift, soft drop and both rotations with the
+// rules' wall kicks. Scratch space is reused between calls, so one instance
+// must not be shared between threads.
+class MoveGenerator {
+public:
+    MoveGenerator();
+
+    // Search as the rules play under 20G: the piece drops to rest after
+    // every shift and rotation, so there is no soft drop
+    void setInstantGravity(bool enabled) { instantGravity_ = enabled; }
+
+    // Every distinct lock position reachable from piece. Placements that
+    // cover the same cells with a different rotation index are reported
+    // once. Empty when piece does not fit or starts outside the board's
+    // rows. The returned vector is reused by the next call.
+    const std::vector<Piece>& findPlacements(const Board& board, const Piece& piece);
+
+    // Shortest action sequence taking piece to target, ending in a hard drop
+    // once only downward moves remain. Returns false if target is unreachable.
+    bool findPath(const Board& board, const Piece& piece, const Piece& target,
+                  std::vector<InputAction>& path);
+
+    // Cells covered by a piece, as a key that is equal for equal footprints
+    static uint32_t footprintKey(const Piece& piece);
+
+private:
+    static constexpr int COLUMNS = Board::WIDTH + 3; // x ranges over [-3, WIDTH)
+    static constexpr int STATES = 4 * Board::TOTAL_ROWS * COLUMNS;
+
+    // Moves only go down and sideways, so a start inside the state
+    // arrays keeps the whole search there
+    static bool inSearchSpace(const Piece& piece);
+    static int stateIndex(const Piece& piece);
+    static Piece stateFromIndex(PieceType type, int index);
+
+    static constexpr uint32_t NO_FOOTPRINT = ~0u;
+
+    // BFS from piece, stopping once a state covering stopAtFootprint is expanded
+    void search(const Board& board, const Piece& piece, uint32_t stopAtFootprint);
+    bool visited(int index) const { return stamp_[index] == generation_; }
+
+    std::array<uint32_t, STATES> stamp_;
+    std::array<int16_t, STATES> parent_;
+    std::array<InputAction, STATES> move_;
+    std::array<int16_t, STATES> queue_;
+    std::array<uint32_t, STATES> footprintStamp_;
+    uint32_t generation_;
+    int queueSize_;
+    bool instantGravity_;
+
+    std::vector<Piece> placements_;
+};
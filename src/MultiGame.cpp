@@ -0,0 +1,131 @@
+#include "MultiGame.hpp"
+#include <algorithm>
+#include "Policy.hpp"
+#include "ThreadPool.hpp"
+#include "Trace.hpp"
+
+namespace {
+
+// Tasks per pool thread, so a chunk of slow bot searches does not hold up
+// the whole tick
+constexpr int CHUNKS_PER_THREAD = 4;
+
+void accumulate(StepResult& total, const StepResult& step) {
+    total.piecesLocked += step.piecesLocked;
+    total.linesCleared += step.linesCleared;
+}
+
+} // namespace
+
+MultiGame::MultiGame(int boards, uint32_t seed, bool sharedSeed, Randomizer randomizer)
+    : boards_(boards)
+    , generators_(boards)
+    , current_(boards)
+    , status_(boards)
+    , score_(boards)
+    , level_(boards)
+    , linesCleared_(boards)
+    , pieces_(boards)
+    , fallTimer_(boards)
+    , fallInterval_(boards)
+    , policies_(boards)
+    , autoRestart_(false)
+    , pool_(nullptr) {
+    setThreadPool(nullptr);
+    for (int i = 0; i < boards; ++i) {
+        rules::reset(game(i), sharedSeed ? seed : seed + static_cast<uint32_t>(i), randomizer);
+    }
+}
+
+MultiGame::~MultiGame() = default;
+MultiGame::MultiGame(MultiGame&&) noexcept = default;
+MultiGame& MultiGame::operator=(MultiGame&&) noexcept = default;
+
+void MultiGame::setPolicy(int index, std::unique_ptr<Policy> policy) {
+    policies_[index] = std::move(policy);
+}
+
+void MultiGame::setThreadPool(ThreadPool* pool) {
+    pool_ = pool;
+    const int count = size();
+    int chunkCount = pool ? std::min(count, static_cast<int>(pool->size()) * CHUNKS_PER_THREAD) : 1;
+    chunkCount = std::max(chunkCount, 1);
+
+    chunks_.assign(chunkCount, Chunk{});
+    for (int c = 0; c < chunkCount; ++c) {
+        chunks_[c].begin = count * c / chunkCount;
+        chunks_[c].end = count * (c + 1) / chunkCount;
+    }
+}
+
+void MultiGame::reset(int index, uint32_t seed) {
+    rules::reset(game(index), seed, generators_[index].randomizer());
+}
+
+StepResult MultiGame::applyAction(int index, InputAction action) {
+    return rules::applyAction(game(index), action);
+}
+
+void MultiGame::runPolicies(Chunk& chunk) {
+    chunk.result = StepResult();
+    for (int i = chunk.begin; i < chunk.end; ++i) {
+        if (!policies_[i]) continue;
+        if (status_[i] == GameStatus::GAME_OVER && autoRestart_) {
+            applyAction(i, InputAction::PAUSE);
+        } else if (status_[i] == GameStatus::PLAYING) {
+            gather(i, chunk.scratch);
+            accumulate(chunk.result, applyAction(i, policies_[i]->nextAction(chunk.scratch)));
+        }
+    }
+}
+
+StepResult MultiGame::tick() {
+    TRACE_SCOPE("MultiGame::tick");
+    StepResult total;
+    const int count = size();
+
+    // Each board's policy only touches that board's fields, so ranges of
+    // boards run independently
+    if (pool_ && chunks_.size() > 1) {
+        for (Chunk& chunk : chunks_) {
+            // Two pointers, small enough for std::function to hold inline
+            Chunk* task = &chunk;
+            pool_->submit([this, task] { runPolicies(*task); });
+        }
+        pool_->wait();
+    } else {
+        for (Chunk& chunk : chunks_) runPolicies(chunk);
+    }
+    for (const Chunk& chunk : chunks_) accumulate(total, chunk.result);
+
+    // Most boards only count their gravity timer up; the rules run for the
+    // few whose piece falls this tick. Same steps as rules::tick.
+    for (int i = 0; i < count; ++i) {
+        if (status_[i] != GameStatus::PLAYING) continue;
+        if (fallTimer_[i] + 1 < fallInterval_[i]) {
+            ++fallTimer_[i];
+            continue;
+        }
+        accumulate(total, rules::tick(game(i)));
+    }
+    return total;
+}
+
+GameRef MultiGame::game(int index) {
+    return GameRef{boards_[index], generators_[index], current_[index], status_[index],
+                   score_[index], level_[index], linesCleared_[index], pieces_[index],
+                   fallTimer_[index], fallInterval_[index]};
+}
+
+void MultiGame::gather(int index, GameState& out) const {
+    out.board = boards_[index];
+    out.generator = generators_[index];
+    out.current = current_[index];
+    out.status = status_[index];
+    out.score = score_[index];
+    out.level = level_[index];
+    out.linesCleared = linesCleared_[index];
+    out.pieces = pieces_[index];
+    out.fallTimer = fallTimer_[index];
+    out.fallInterval = fallInterval_[index];
+}
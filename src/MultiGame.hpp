@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Rules.hpp"
+
+class Policy;
+class ThreadPool;
+
+// Many games stepped together, for the versus layout and the spectator
+// wall. Each GameState field is its own array indexed by board, so the
+// per-tick gravity sweep reads only the status and timer arrays and the
+// rules touch a board's cells only when its piece is due to fall.
+class MultiGame {
+public:
+    // Board i plays seed + i, or seed for every board with sharedSeed so
+    // all of them get the same pieces
+    MultiGame(int boards, uint32_t seed, bool sharedSeed = false,
+              Randomizer randomizer = Randomizer::BAG);
+    ~MultiGame();
+    MultiGame(MultiGame&&) noexcept;
+    MultiGame& operator=(MultiGame&&) noexcept;
+
+    int size() const { return static_cast<int>(boards_.size()); }
+
+    // Let a policy play board index; boards without one only move through
+    // applyAction
+    void setPolicy(int index, std::unique_ptr<Policy> policy);
+    // Boards played by a policy start over when they top out
+    void setAutoRestart(bool enabled) { autoRestart_ = enabled; }
+    // Run the policies of tick() on pool, a contiguous range of boards per
+    // task. Null, the default, runs them on the calling thread. The pool
+    // must outlive its use here and policies must not share state.
+    void setThreadPool(ThreadPool* pool);
+
+    void reset(int index, uint32_t seed);
+    StepResult applyAction(int index, InputAction action);
+    // One logic tick for every board: policies pick their actions, then
+    // gravity is applied in a single pass over all boards
+    StepResult tick();
+
+    // The rules' view of one board's fields
+    GameRef game(int index);
+    // Copy one board's game out, for code that takes a GameState
+    void gather(int index, GameState& out) const;
+
+    const Board& board(int index) const { return boards_[index]; }
+    const Piece& current(int index) const { return current_[index]; }
+    Piece preview(int index) const { return Piece(generators_[index].peek(0)); }
+    GameStatus status(int index) const { return status_[index]; }
+    int score(int index) const { return score_[index]; }
+    int level(int index) const { return level_[index]; }
+    int lines(int index) const { return linesCleared_[index]; }
+    int pieces(int index) const { return pieces_[index]; }
+
+private:
+    // One task's range of boards, with its own scratch state and totals
+    struct Chunk {
+        int begin;
+        int end;
+        GameState scratch;
+        StepResult result;
+    };
+
+    void runPolicies(Chunk& chunk);
+
+    std::vector<Board> boards_;
+    std::vector<PieceGenerator> generators_;
+    std::vector<Piece> current_;
+    std::vector<GameStatus> status_;
+    std::vector<int> score_;
+    std::vector<int> level_;
+    std::vector<int> linesCleared_;
+    std::vector<int> pieces_;
+    std::vector<int> fallTimer_;
+    std::vector<int> fallInterval_;
+
+    std::vector<std::unique_ptr<Policy>> policies_;
+    bool autoRestart_;
+    ThreadPool* pool_;
+    // Policies read a whole GameState, gathered into their chunk's scratch
+    // one board at a time. A single chunk without a pool.
+    std::vector<Chunk> chunks_;
+};
@@ -0,0 +1,362 @@
+#include "Netplay.hpp"
+#include "Trace.hpp"
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+constexpr SocketHandle NO_SOCKET = INVALID_SOCKET;
+
+void closeSocket(SocketHandle socket) { closesocket(socket); }
+
+bool setNonBlocking(SocketHandle socket) {
+    u_long enabled = 1;
+    return ioctlsocket(socket, FIONBIO, &enabled) == 0;
+}
+
+// Winsock needs starting once per process before the first socket
+bool startSockets() {
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+#else
+using SocketHandle = int;
+constexpr SocketHandle NO_SOCKET = -1;
+
+void closeSocket(SocketHandle socket) { ::close(socket); }
+
+bool setNonBlocking(SocketHandle socket) {
+    int flags = fcntl(socket, F_GETFL, 0);
+    return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool startSockets() { return true; }
+#endif
+
+sockaddr_in loopbackAddress(uint16_t port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return address;
+}
+
+SocketHandle handle(intptr_t socket) { return static_cast<SocketHandle>(socket); }
+
+// Packet layout, native byte order since both peers run the same build:
+// magic, first tick, input count, ack, check tick, check hash, inputs
+constexpr uint32_t PACKET_MAGIC = 0x31535654;  // "TVS1"
+constexpr size_t HEADER_SIZE = 4 + 4 + 2 + 4 + 4 + 8;
+
+template <typename T>
+void put(uint8_t*& out, T value) {
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+template <typename T>
+T get(const uint8_t*& in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+uint64_t nanosSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+UdpLink::UdpLink()
+    : socket_(-1)
+    , remotePort_(0)
+    , sent_(0)
+    , dropped_(0) {
+    queue_.reserve(QUEUE_RESERVE);
+}
+
+UdpLink::~UdpLink() {
+    close();
+}
+
+bool UdpLink::open(uint16_t localPort, uint16_t remotePort, const LinkConditions& conditions) {
+    close();
+    if (!startSockets()) return false;
+
+    SocketHandle socket = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socket == NO_SOCKET) return false;
+
+    sockaddr_in local = loopbackAddress(localPort);
+    if (bind(socket, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) != 0 ||
+        !setNonBlocking(socket)) {
+        closeSocket(socket);
+        return false;
+    }
+
+    socket_ = static_cast<intptr_t>(socket);
+    remotePort_ = remotePort;
+    conditions_ = conditions;
+    rng_.seed(conditions.seed);
+    return true;
+}
+
+void UdpLink::close() {
+    if (socket_ != -1) {
+        closeSocket(handle(socket_));
+        socket_ = -1;
+    }
+    queue_.clear();
+}
+
+void UdpLink::send(const uint8_t* data, size_t size) {
+    if (socket_ == -1 || size > MAX_PACKET) return;
+
+    if (conditions_.lossPercent > 0.0 &&
+        std::uniform_real_distribution<double>(0.0, 100.0)(rng_) < conditions_.lossPercent) {
+        ++dropped_;
+        return;
+    }
+
+    int delayMs = conditions_.latencyMs;
+    if (conditions_.jitterMs > 0) {
+        delayMs += std::uniform_int_distribution<int>(0, conditions_.jitterMs)(rng_);
+    }
+    if (queue_.size() == queue_.capacity()) {
+        // A stalled peer should not grow the queue without bound
+        ++dropped_;
+        return;
+    }
+    queue_.push_back(Delayed{Clock::now() + std::chrono::milliseconds(delayMs), size, {}});
+    std::memcpy(queue_.back().data.data(), data, size);
+    flush();
+}
+
+void UdpLink::flush() {
+    if (queue_.empty()) return;
+
+    const Clock::time_point now = Clock::now();
+    const sockaddr_in remote = loopbackAddress(remotePort_);
+    // Due datagrams leave, the rest keep their order
+    size_t kept = 0;
+    for (size_t i = 0; i < queue_.size(); ++i) {
+        if (queue_[i].due <= now) {
+            sendto(handle(socket_), reinterpret_cast<const char*>(queue_[i].data.data()),
+                   static_cast<int>(queue_[i].size), 0,
+                   reinterpret_cast<const sockaddr*>(&remote), sizeof(remote));
+            ++sent_;
+        } else {
+            if (kept != i) queue_[kept] = queue_[i];
+            ++kept;
+        }
+    }
+    queue_.resize(kept);
+}
+
+size_t UdpLink::receive(uint8_t* buffer, size_t capacity) {
+    if (socket_ == -1) return 0;
+    // Errors such as a refused port while the peer is not up yet read as
+    // nothing received
+    auto received = recv(handle(socket_), reinterpret_cast<char*>(buffer), static_cast<int>(capacity), 0);
+    return received > 0 ? static_cast<size_t>(received) : 0;
+}
+
+RollbackSession::RollbackSession(UdpLink& link, const NetplayConfig& config)
+    : link_(link)
+    , localPlayer_(config.localPlayer)
+    // Prediction and delay together must leave room in the history for
+    // inputs still on their way
+    , maxPrediction_(std::max(1, std::min(config.maxPrediction, HISTORY / 2)))
+    , state_()
+    , tick_(0)
+    , localScheduled_(0)
+    , remoteReceived_(0)
+    , remoteAcked_(0)
+    , rollbackFrom_(0)
+    , sentScheduled_(0)
+    , sentReceived_(0)
+    , sentAt_()
+    , remoteCheckPending_(false)
+    , remoteCheckTick_(0)
+    , remoteCheckHash_(0) {
+    versus::reset(state_, config.seed);
+    localInputs_.fill(InputAction::NONE);
+    remoteInputs_.fill(InputAction::NONE);
+    // The first ticks run before any key can reach them
+    localScheduled_ = static_cast<uint32_t>(std::max(0, std::min(config.inputDelay, HISTORY / 4)));
+}
+
+void RollbackSession::poll() {
+    TRACE_SCOPE("RollbackSession::poll");
+    link_.flush();
+
+    uint8_t buffer[UdpLink::MAX_PACKET];
+    while (size_t size = link_.receive(buffer, sizeof(buffer))) {
+        receivePacket(buffer, size);
+    }
+    rollback();
+    checkRemoteHash();
+    if (!canAdvance()) {
+        ++stats_.stalls;
+    }
+
+    bool news = localScheduled_ != sentScheduled_ || remoteReceived_ != sentReceived_;
+    auto now = std::chrono::steady_clock::now();
+    if (news || now - sentAt_ >= std::chrono::milliseconds(RESEND_INTERVAL_MS)) {
+        sendInputs();
+        sentScheduled_ = localScheduled_;
+        sentReceived_ = remoteReceived_;
+        sentAt_ = now;
+    }
+}
+
+bool RollbackSession::canAdvance() const {
+    return tick_ < remoteReceived_ + static_cast<uint32_t>(maxPrediction_) &&
+           localScheduled_ < remoteAcked_ + HISTORY;
+}
+
+bool RollbackSession::advance(InputAction local) {
+    if (!canAdvance()) return false;
+    localInputs_[localScheduled_ % HISTORY] = local;
+    ++localScheduled_;
+    simulate();
+    return true;
+}
+
+VersusState RollbackSession::scheduledState() const {
+    VersusState ahead = state_;
+    for (uint32_t t = tick_; t < localScheduled_; ++t) {
+        InputAction local = localInputs_[t % HISTORY];
+        InputAction remote = t < remoteReceived_ ? remoteInputs_[t % HISTORY] : InputAction::NONE;
+        if (localPlayer_ == 0) {
+            versus::step(ahead, local, remote);
+        } else {
+            versus::step(ahead, remote, local);
+        }
+    }
+    return ahead;
+}
+
+void RollbackSession::simulate() {
+    states_[tick_ % HISTORY] = state_;
+    InputAction local = localInputs_[tick_ % HISTORY];
+    InputAction remote = tick_ < remoteReceived_ ? remoteInputs_[tick_ % HISTORY] : InputAction::NONE;
+    if (localPlayer_ == 0) {
+        versus::step(state_, local, remote);
+    } else {
+        versus::step(state_, remote, local);
+    }
+    ++tick_;
+    rollbackFrom_ = std::max(rollbackFrom_, tick_);
+}
+
+void RollbackSession::rollback() {
+    if (rollbackFrom_ >= tick_) return;
+    TRACE_SCOPE("RollbackSession::rollback");
+    auto start = std::chrono::steady_clock::now();
+
+    const uint32_t present = tick_;
+    const int depth = static_cast<int>(present - rollbackFrom_);
+    state_ = states_[rollbackFrom_ % HISTORY];
+    tick_ = rollbackFrom_;
+    while (tick_ < present) {
+        simulate();
+    }
+
+    ++stats_.rollbacks;
+    stats_.resimulatedTicks += static_cast<uint64_t>(depth);
+    stats_.maxRollback = std::max(stats_.maxRollback, depth);
+    stats_.rollbackNanos += nanosSince(start);
+}
+
+void RollbackSession::receivePacket(const uint8_t* data, size_t size) {
+    if (size < HEADER_SIZE) return;
+    const uint8_t* in = data;
+    if (get<uint32_t>(in) != PACKET_MAGIC) return;
+    uint32_t first = get<uint32_t>(in);
+    uint16_t count = get<uint16_t>(in);
+    uint32_t ack = get<uint32_t>(in);
+    uint32_t checkTick = get<uint32_t>(in);
+    uint64_t checkHash = get<uint64_t>(in);
+    if (size != HEADER_SIZE + count) return;
+
+    remoteAcked_ = std::max(remoteAcked_, std::min(ack, localScheduled_));
+    if (!remoteCheckPending_ || checkTick > remoteCheckTick_) {
+        remoteCheckPending_ = true;
+        remoteCheckTick_ = checkTick;
+        remoteCheckHash_ = checkHash;
+    }
+
+    // Inputs are taken in order only; a gap left by a lost packet is filled
+    // by the next one, which resends everything from our ack on. Nothing is
+    // taken that would overwrite an input a rollback may still need.
+    const uint32_t limit = tick_ + static_cast<uint32_t>(HISTORY - maxPrediction_);
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t tick = first + i;
+        if (tick < remoteReceived_) continue;
+        if (tick > remoteReceived_ || tick >= limit) break;
+
+        uint8_t raw = in[i];
+        InputAction action = raw <= static_cast<uint8_t>(InputAction::HARD_DROP)
+                                 ? static_cast<InputAction>(raw) : InputAction::NONE;
+        remoteInputs_[tick % HISTORY] = action;
+        // Ticks already run used the NONE prediction
+        if (tick < tick_ && action != InputAction::NONE) {
+            rollbackFrom_ = std::min(rollbackFrom_, tick);
+        }
+        ++remoteReceived_;
+    }
+}
+
+void RollbackSession::sendInputs() {
+    // The oldest unacknowledged inputs go first if they do not all fit
+    uint32_t first = remoteAcked_;
+    uint32_t count = std::min<uint32_t>(localScheduled_ - first, HISTORY);
+    uint32_t checkTick = confirmedTick();
+
+    uint8_t buffer[HEADER_SIZE + HISTORY];
+    uint8_t* out = buffer;
+    put<uint32_t>(out, PACKET_MAGIC);
+    put<uint32_t>(out, first);
+    put<uint16_t>(out, static_cast<uint16_t>(count));
+    put<uint32_t>(out, remoteReceived_);
+    put<uint32_t>(out, checkTick);
+    put<uint64_t>(out, versus::hash(stateAt(checkTick)));
+    for (uint32_t i = 0; i < count; ++i) {
+        *out++ = static_cast<uint8_t>(localInputs_[(first + i) % HISTORY]);
+    }
+    link_.send(buffer, static_cast<size_t>(out - buffer));
+}
+
+void RollbackSession::checkRemoteHash() {
+    if (!remoteCheckPending_ || remoteCheckTick_ > confirmedTick()) return;
+    remoteCheckPending_ = false;
+    // Too old to compare once it has left the history
+    if (remoteCheckTick_ + HISTORY <= tick_) return;
+
+    ++stats_.checks;
+    if (versus::hash(stateAt(remoteCheckTick_)) != remoteCheckHash_) {
+        ++stats_.desyncs;
+    }
+}
+
+const VersusState& RollbackSession::stateAt(uint32_t tick) const {
+    return tick == tick_ ? state_ : states_[tick % HISTORY];
+}
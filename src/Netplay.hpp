@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "Versus.hpp"
+
+// Conditions injected on the sending side of a link, so rollback can be
+// exercised over loopback where the real network adds next to nothing
+struct LinkConditions {
+    int latencyMs = 0;
+    int jitterMs = 0;           // extra delay, uniform in [0, jitterMs]
+    double lossPercent = 0.0;
+    uint32_t seed = 1;
+};
+
+// Non-blocking UDP socket between two ports on 127.0.0.1. Outgoing
+// datagrams wait in a queue until their injected delay has passed, so
+// jitter can reorder them like a real network would.
+class UdpLink {
+public:
+    static constexpr size_t MAX_PACKET = 128;
+
+    UdpLink();
+    ~UdpLink();
+
+    UdpLink(const UdpLink&) = delete;
+    UdpLink& operator=(const UdpLink&) = delete;
+
+    bool open(uint16_t localPort, uint16_t remotePort, const LinkConditions& conditions = LinkConditions());
+    void close();
+
+    // Queue a datagram of at most MAX_PACKET bytes, or drop it per the
+    // loss setting
+    void send(const uint8_t* data, size_t size);
+    // Put queued datagrams whose delay has passed on the wire
+    void flush();
+    // Size of the next datagram received, 0 when none is waiting
+    size_t receive(uint8_t* buffer, size_t capacity);
+
+    uint64_t sent() const { return sent_; }
+    uint64_t dropped() const { return dropped_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Delayed {
+        Clock::time_point due;
+        size_t size;
+        std::array<uint8_t, MAX_PACKET> data;
+    };
+
+    static constexpr size_t QUEUE_RESERVE = 1024;
+
+    intptr_t socket_;           // -1 when closed
+    uint16_t remotePort_;
+    LinkConditions conditions_;
+    std::mt19937 rng_;
+    std::vector<Delayed> queue_;
+    uint64_t sent_;
+    uint64_t dropped_;
+};
+
+struct NetplayConfig {
+    uint16_t localPort = 7777;
+    uint16_t remotePort = 7778;
+    int localPlayer = 0;        // board this peer plays, the peer has the other
+    uint32_t seed = 1;          // both peers must use the same seed
+    int inputDelay = 2;         // ticks between reading a key and applying it
+    int maxPrediction = 20;     // ticks simulated past the last remote input
+    LinkConditions link;
+};
+
+struct NetplayStats {
+    uint64_t rollbacks = 0;
+    uint64_t resimulatedTicks = 0;
+    int maxRollback = 0;            // most ticks re-run by one rollback
+    uint64_t rollbackNanos = 0;     // restoring and re-running, all rollbacks
+    uint64_t stalls = 0;            // polls that left the prediction window full
+    uint64_t checks = 0;            // confirmed states compared with the peer
+    uint64_t desyncs = 0;
+};
+
+// One peer of a versus match. Only inputs cross the wire: each packet
+// carries every local input the peer has not acknowledged yet, so a lost
+// packet is covered by the next one. Remote inputs that have not arrived
+// are predicted as NONE, since actions are single key presses and most
+// ticks have none. When a remote input turns out to differ, the match is
+// restored from the state saved at that tick and re-run up to the present
+// within the same call.
+class RollbackSession {
+public:
+    // Ticks of states and inputs kept, covering the prediction window plus
+    // inputs in flight
+    static constexpr int HISTORY = 64;
+    // Without new inputs or acks the last packet is repeated this often,
+    // in case it was lost
+    static constexpr int RESEND_INTERVAL_MS = 20;
+
+    RollbackSession(UdpLink& link, const NetplayConfig& config);
+
+    // Receive remote inputs, roll back if any was mispredicted, then send
+    // our unacknowledged inputs. Call once per frame.
+    void poll();
+    // False while the prediction window is used up; the caller keeps its
+    // input and tries again after the next poll()
+    bool canAdvance() const;
+    // Schedule the local input for tick() + input delay and run one tick
+    bool advance(InputAction local);
+    // state() run forward through the local inputs already scheduled, with
+    // the remote ones predicted as NONE. The input passed to advance() next
+    // applies to this state, so a policy should decide on it.
+    VersusState scheduledState() const;
+
+    const VersusState& state() const { return state_; }
+    // The latest state every remote input is known for; it no longer
+    // changes and is the same on both peers
+    const VersusState& confirmedState() const { return stateAt(confirmedTick()); }
+    int localPlayer() const { return localPlayer_; }
+    // Ticks simulated, and ticks whose inputs from both sides are known
+    uint32_t tick() const { return tick_; }
+    uint32_t confirmedTick() const { return std::min(tick_, remoteReceived_); }
+    const NetplayStats& stats() const { return stats_; }
+
+private:
+    void receivePacket(const uint8_t* data, size_t size);
+    void sendInputs();
+    void rollback();
+    void checkRemoteHash();
+    void simulate();
+    const VersusState& stateAt(uint32_t tick) const;
+
+    UdpLink& link_;
+    int localPlayer_;
+    int maxPrediction_;
+
+    VersusState state_;             // at the start of tick_
+    uint32_t tick_;
+    // State at the start of each of the last HISTORY ticks, by tick % HISTORY
+    std::array<VersusState, HISTORY> states_;
+    std::array<InputAction, HISTORY> localInputs_;
+    std::array<InputAction, HISTORY> remoteInputs_;
+
+    uint32_t localScheduled_;       // local inputs are set below this tick
+    uint32_t remoteReceived_;       // remote inputs are known below this tick
+    uint32_t remoteAcked_;          // the peer has our inputs below this tick
+    uint32_t rollbackFrom_;         // earliest mispredicted tick, tick_ if none
+
+    // What the last packet carried, so unchanged ones go out only to resend
+    uint32_t sentScheduled_;
+    uint32_t sentReceived_;
+    std::chrono::steady_clock::time_point sentAt_;
+
+    // Latest confirmed-state hash from the peer, checked once we confirm it too
+    bool remoteCheckPending_;
+    uint32_t remoteCheckTick_;
+    uint64_t remoteCheckHash_;
+
+    NetplayStats stats_;
+};
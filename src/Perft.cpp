@@ -0,0 +1,134 @@
+#include "Perft.hpp"
+#include "ThreadPool.hpp"
+#include <cstring>
+#include <memory>
+
+namespace {
+
+constexpr char PIECE_LETTERS[] = "IOTSZJL"; // in PieceType order
+
+// The sequence as seen by the next piece
+std::vector<PieceType> rotateSequence(const std::vector<PieceType>& pieces) {
+    std::vector<PieceType> next(pieces.begin() + 1, pieces.end());
+    next.push_back(pieces.front());
+    return next;
+}
+
+Board lockPlacement(const Board& board, const Piece& placement) {
+    Board child = board;
+    child.place(placement.getMask(), placement.getX(), placement.getY(), placement.getColor());
+    child.clearLines();
+    return child;
+}
+
+} // namespace
+
+uint64_t Perft::count(const Board& board, const std::vector<PieceType>& pieces, int depth) {
+    if (depth <= 0) return 1;
+    if (pieces.empty()) return 0;
+    if (static_cast<int>(levels_.size()) < depth) levels_.resize(depth);
+    return countFrom(board, pieces, 0, depth);
+}
+
+uint64_t Perft::countFrom(const Board& board, const std::vector<PieceType>& pieces, int level, int depth) {
+    Piece spawn(pieces[level % pieces.size()]);
+    const std::vector<Piece>& placements = moveGen_.findPlacements(board, spawn);
+    // The last piece only needs counting
+    if (level + 1 == depth) return placements.size();
+
+    std::vector<Piece>& mine = levels_[level];
+    mine.assign(placements.begin(), placements.end());
+    uint64_t nodes = 0;
+    for (const Piece& placement : mine) {
+        nodes += countFrom(lockPlacement(board, placement), pieces, level + 1, depth);
+    }
+    return nodes;
+}
+
+uint64_t perftParallel(ThreadPool& pool, const Board& board, const std::vector<PieceType>& pieces,
+                       int depth, bool instantGravity, std::vector<PerftDivide>* divide) {
+    if (divide) divide->clear();
+    if (depth <= 0) return 1;
+    if (pieces.empty()) return 0;
+
+    std::vector<Piece> roots;
+    {
+        MoveGenerator moveGen;
+        moveGen.setInstantGravity(instantGravity);
+        roots = moveGen.findPlacements(board, Piece(pieces.front()));
+    }
+
+    std::vector<uint64_t> nodes(roots.size(), depth == 1 ? 1 : 0);
+    if (depth > 1) {
+        const std::vector<PieceType> rest = rotateSequence(pieces);
+        for (size_t i = 0; i < roots.size(); ++i) {
+            pool.submit([&, i] {
+                // Each task owns its search scratch, a few KB
+                auto perft = std::make_unique<Perft>();
+                perft->setInstantGravity(instantGravity);
+                nodes[i] = perft->count(lockPlacement(board, roots[i]), rest, depth - 1);
+            });
+        }
+        pool.wait();
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < roots.size(); ++i) {
+        total += nodes[i];
+        if (divide) divide->push_back(PerftDivide{roots[i], nodes[i]});
+    }
+    return total;
+}
+
+const std::vector<PerftPosition>& perftPositions() {
+    // Checked against a separate brute-force search that compares lock
+    // positions as sets of cells; jagged and cave only up to depth 3
+    static const std::vector<PerftPosition> positions = {
+        {"empty", "", "TIOLJSZ", false, {34, 596, 5542, 198927}},
+        {"empty-20g", "", "TIOLJSZ", true, {34, 396, 2619, 77387}},
+        // tetris_bench's move_gen board: an uneven stack with buried holes
+        {"jagged", "...X....../.X.X...X../.X.X.X.X../X..X.X.XX./XXX..X.XX./"
+                   "XXXXX..XX./XXXXXXX.X./XXXXXXXXX./.XXXXXXXX.", "LJSZTOI", false, {34, 1196, 21351, 396544}},
+        // A cave behind a two-wide opening, filled by soft drops, shifts
+        // and kicks under the roof
+        {"cave", "XXXX..XXXX/X........X/X........X/XXX.XX.XXX", "TSZL", false, {52, 1138, 23779, 954233}},
+        // A four-row well, so line clears change what the next piece sees
+        {"well", "XXXXXXXXX./XXXXXXXXX./XXXXXXXXX./XXXXXXXXX.", "IOIT", false, {17, 153, 2632, 93576}},
+    };
+    return positions;
+}
+
+bool parsePerftBoard(const std::string& rows, Board& board) {
+    board = Board();
+    if (rows.empty()) return true;
+
+    std::vector<std::string> lines;
+    size_t start = 0;
+    while (true) {
+        size_t end = rows.find('/', start);
+        lines.push_back(rows.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+    if (static_cast<int>(lines.size()) > Board::TOTAL_ROWS) return false;
+
+    int top = Board::TOTAL_ROWS - static_cast<int>(lines.size());
+    for (size_t row = 0; row < lines.size(); ++row) {
+        const std::string& line = lines[row];
+        if (static_cast<int>(line.size()) != Board::WIDTH) return false;
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            if (line[x] != '.') board.setCell(x, top + static_cast<int>(row), 1);
+        }
+    }
+    return true;
+}
+
+bool parsePerftPieces(const std::string& letters, std::vector<PieceType>& pieces) {
+    pieces.clear();
+    for (char letter : letters) {
+        const char* found = letter ? std::strchr(PIECE_LETTERS, letter) : nullptr;
+        if (!found) return false;
+        pieces.push_back(static_cast<PieceType>(found - PIECE_LETTERS));
+    }
+    return !pieces.empty();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Board.hpp"
+#include "MoveGen.hpp"
+
+class ThreadPool;
+
+// Placement perft: the number of ways to lock depth pieces in a row. Each
+// piece spawns once the previous one has locked and its lines have
+// cleared, and can go to any lock position findPlacements reports. Like
+// chess perft it counts leaves of the tree, so different orders reaching
+// the same board count separately. The sequence repeats when depth is
+// longer than it.
+class Perft {
+public:
+    Perft() = default;
+
+    // Search as the rules play under 20G, see MoveGenerator
+    void setInstantGravity(bool enabled) { moveGen_.setInstantGravity(enabled); }
+
+    uint64_t count(const Board& board, const std::vector<PieceType>& pieces, int depth);
+
+private:
+    uint64_t countFrom(const Board& board, const std::vector<PieceType>& pieces, int level, int depth);
+
+    MoveGenerator moveGen_;
+    // Placements of each level, copied out of moveGen_ before recursing
+    std::vector<std::vector<Piece>> levels_;
+};
+
+struct PerftDivide {
+    Piece placement;    // lock position of the first piece
+    uint64_t nodes;     // leaves under it
+};
+
+// count() with one task on pool per placement of the first piece. The
+// per-placement counts go to divide when it is not null, in the order
+// findPlacements reports them.
+uint64_t perftParallel(ThreadPool& pool, const Board& board, const std::vector<PieceType>& pieces,
+                       int depth, bool instantGravity, std::vector<PerftDivide>* divide = nullptr);
+
+// A position with known counts, to check a move generator against
+struct PerftPosition {
+    const char* name;
+    // Rows from the top down, separated by '/', '.' for an empty cell and
+    // anything else for a block. They sit on the floor of the board.
+    const char* rows;
+    const char* pieces;     // piece letters, e.g. "TIOLJSZ"
+    bool instantGravity;
+    std::vector<uint64_t> expected; // count at depth 1, 2, ...
+};
+
+const std::vector<PerftPosition>& perftPositions();
+
+// False on a malformed row or an unknown letter
+bool parsePerftBoard(const std::string& rows, Board& board);
+bool parsePerftPieces(const std::string& letters, std::vector<PieceType>& pieces);
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <array>
-#include <vector>
+#include <cstdint>
+#include <utility>
+#include "PieceShapes.hpp"
 
-enum class PieceType {
+enum class PieceType : int8_t {
     I = 0,
     O = 1,
     T = 2,
@@ -16,33 +18,41 @@ enum class PieceType {
 
 class Piece {
 public:
+    // Board cells a piece covers, in place so reading them never allocates
+    struct Blocks {
+        std::array<std::pair<int, int>, 4> cells;
+        int count = 0;      // 4, or 0 for PieceType::NONE
+
+        const std::pair<int, int>* begin() const { return cells.data(); }
+        const std::pair<int, int>* end() const { return cells.data() + count; }
+        bool empty() const { return count == 0; }
+    };
+    
     Piece();
     explicit Piece(PieceType type);
     
-    static Piece createRandom();
-    
     PieceType getType() const { return type_; }
     int getX() const { return x_; }
     int getY() const { return y_; }
     int getRotation() const { return rotation_; }
     
-    void setX(int x) { x_ = x; }
-    void setY(int y) { y_ = y; }
-    void setRotation(int rotation) { rotation_ = rotation % 4; }
+    void setX(int x) { x_ = static_cast<int8_t>(x); }
+    void setY(int y) { y_ = static_cast<int8_t>(y); }
+    void setRotation(int rotation) { rotation_ = static_cast<int8_t>(rotation % 4); }
     
     void move(int dx, int dy);
     void rotate(int direction); // 1 = clockwise, -1 = counter-clockwise
     
-    std::vector<std::pair<int, int>> getBlocks() const;
+    Blocks getBlocks() const;
+    const PieceMask& getMask() const { return PIECE_MASKS[static_cast<int>(type_)][rotation_]; }
     int getColor() const;
     
     static constexpr int BLOCK_SIZE = 4;
     
 private:
-    static const std::array<std::array<std::array<std::array<bool, 4>, 4>, 4>, 7> rotations_;
-    
+    // Four bytes, so pieces copy as cheaply as an int inside a GameState
     PieceType type_;
-    int x_;
-    int y_;
-    int rotation_;
+    int8_t x_;
+    int8_t y_;
+    int8_t rotation_;
 };
@@ -0,0 +1,59 @@
+#include "PieceGenerator.hpp"
+#include <utility>
+
+namespace {
+
+constexpr uint64_t PCG_MULTIPLIER = 6364136223846793005ull;
+constexpr uint64_t PCG_INCREMENT = 1442695040888963407ull;
+
+} // namespace
+
+void PieceGenerator::reset(uint32_t seed, Randomizer randomizer) {
+    // pcg32_srandom with a fixed stream
+    rng_ = 0;
+    next();
+    rng_ += seed;
+    next();
+    randomizer_ = randomizer;
+    head_ = 0;
+    size_ = 0;
+    while (size_ <= MAX_PREVIEW) {
+        refill();
+    }
+}
+
+PieceType PieceGenerator::pop() {
+    PieceType type = queue_[head_];
+    head_ = (head_ + 1) & MASK;
+    if (--size_ <= MAX_PREVIEW) {
+        refill();
+    }
+    return type;
+}
+
+uint32_t PieceGenerator::next() {
+    uint64_t old = rng_;
+    rng_ = old * PCG_MULTIPLIER + PCG_INCREMENT;
+    uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+    uint32_t rotation = static_cast<uint32_t>(old >> 59);
+    return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+}
+
+void PieceGenerator::refill() {
+    std::array<PieceType, BATCH> batch;
+    for (int i = 0; i < BATCH; ++i) {
+        batch[i] = static_cast<PieceType>(randomizer_ == Randomizer::BAG ? i : below(BATCH));
+    }
+
+    if (randomizer_ == Randomizer::BAG) {
+        // Fisher-Yates
+        for (int i = BATCH - 1; i > 0; --i) {
+            std::swap(batch[i], batch[below(i + 1)]);
+        }
+    }
+
+    for (PieceType type : batch) {
+        queue_[(head_ + size_) & MASK] = type;
+        ++size_;
+    }
+}
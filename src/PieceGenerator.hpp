@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include "Piece.hpp"
+
+enum class Randomizer : uint8_t {
+    UNIFORM = 0,    // each piece drawn independently
+    BAG = 1         // every run of 7 pieces is a shuffled set of all 7 types
+};
+
+// Per-game stream of upcoming pieces. Types are generated a batch of 7 at a
+// time into a fixed ring buffer, so popping and previewing never allocate.
+// All of its state is a few dozen plain bytes, so copying it is a memcpy.
+class PieceGenerator {
+public:
+    // Pieces that can be looked at ahead of the one being popped
+    static constexpr int MAX_PREVIEW = 6;
+
+    PieceGenerator() { reset(0, Randomizer::BAG); }
+
+    void reset(uint32_t seed, Randomizer randomizer);
+
+    PieceType pop();
+    // Upcoming type, 0 = the next pop(). index must be below MAX_PREVIEW.
+    PieceType peek(int index) const { return queue_[(head_ + index) & MASK]; }
+
+    Randomizer randomizer() const { return randomizer_; }
+
+    // Identifies the stream position: the PCG state can be stepped back, so
+    // it also determines the types already queued
+    uint64_t hash() const {
+        return rng_ ^ (uint64_t(size_) << 56) ^ (uint64_t(randomizer_) << 63);
+    }
+
+private:
+    static constexpr int BATCH = 7;
+    static constexpr uint32_t CAPACITY = 16;
+    static constexpr uint32_t MASK = CAPACITY - 1;
+    static_assert((CAPACITY & MASK) == 0, "ring buffer size must be a power of two");
+    static_assert(MAX_PREVIEW + BATCH <= static_cast<int>(CAPACITY), "a refill must fit behind the preview");
+
+    void refill();
+    // PCG32 (XSH RR): 8 bytes of state where std::mt19937 needs 2.5 KB, and
+    // the same stream from every standard library
+    uint32_t next();
+    // Uniform in [0, n), from the raw engine output so streams match across
+    // standard libraries (std::uniform_int_distribution is not portable)
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>((uint64_t(next()) * n) >> 32); }
+
+    uint64_t rng_;
+    uint32_t head_;
+    uint32_t size_;
+    std::array<PieceType, CAPACITY> queue_;
+    Randomizer randomizer_;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Tetromino rotation data [PieceType][rotation][y][x]
+using PieceShapeTable = std::array<std::array<std::array<std::array<bool, 4>, 4>, 4>, 7>;
+
+inline constexpr PieceShapeTable PIECE_SHAPES = {{
+    // I-Piece (Cyan)
+    {{
+        {{{0,0,0,0},{1,1,1,1},{0,0,0,0},{0,0,0,0}}},
+        {{{0,0,1,0},{0,0,1,0},{0,0,1,0},{0,0,1,0}}},
+        {{{0,0,0,0},{0,0,0,0},{1,1,1,1},{0,0,0,0}}},
+        {{{0,1,0,0},{0,1,0,0},{0,1,0,0},{0,1,0,0}}}
+    }},
+    // O-Piece (Yellow)
+    {{
+        {{{0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,1,1,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}}}
+    }},
+    // T-Piece (Purple)
+    {{
+        {{{0,1,0,0},{1,1,1,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,1,0,0},{0,1,1,0},{0,1,0,0},{0,0,0,0}}},
+        {{{0,0,0,0},{1,1,1,0},{0,1,0,0},{0,0,0,0}}},
+        {{{0,1,0,0},{1,1,0,0},{0,1,0,0},{0,0,0,0}}}
+    }},
+    // S-Piece (Green)
+    {{
+        {{{0,1,1,0},{1,1,0,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,1,0,0},{0,1,1,0},{0,0,1,0},{0,0,0,0}}},
+        {{{0,0,0,0},{0,1,1,0},{1,1,0,0},{0,0,0,0}}},
+        {{{1,0,0,0},{1,1,0,0},{0,1,0,0},{0,0,0,0}}}
+    }},
+    // Z-Piece (Red)
+    {{
+        {{{1,1,0,0},{0,1,1,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,0,1,0},{0,1,1,0},{0,1,0,0},{0,0,0,0}}},
+        {{{0,0,0,0},{1,1,0,0},{0,1,1,0},{0,0,0,0}}},
+        {{{0,1,0,0},{1,1,0,0},{1,0,0,0},{0,0,0,0}}}
+    }},
+    // J-Piece (Blue)
+    {{
+        {{{1,0,0,0},{1,1,1,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,1,1,0},{0,1,0,0},{0,1,0,0},{0,0,0,0}}},
+        {{{0,0,0,0},{1,1,1,0},{0,0,1,0},{0,0,0,0}}},
+        {{{0,1,0,0},{0,1,0,0},{1,1,0,0},{0,0,0,0}}}
+    }},
+    // L-Piece (Orange)
+    {{
+        {{{0,0,1,0},{1,1,1,0},{0,0,0,0},{0,0,0,0}}},
+        {{{0,1,0,0},{0,1,0,0},{0,1,1,0},{0,0,0,0}}},
+        {{{0,0,0,0},{1,1,1,0},{1,0,0,0},{0,0,0,0}}},
+        {{{1,1,0,0},{0,1,0,0},{0,1,0,0},{0,0,0,0}}}
+    }}
+}};
+
+// Occupancy of one piece rotation as 4 row bitmasks (bit bx set for a block
+// at column offset bx) plus the bounding box of its blocks in the 4x4 grid.
+struct PieceMask {
+    std::array<uint16_t, 4> rows;
+    int8_t minX;
+    int8_t maxX;
+    int8_t minY;
+    int8_t maxY;
+    std::array<int8_t, 4> bottom;   // lowest block row per column offset, -1 if empty
+};
+
+using PieceMaskTable = std::array<std::array<PieceMask, 4>, 7>;
+
+constexpr PieceMaskTable buildPieceMasks(const PieceShapeTable& shapes) {
+    PieceMaskTable masks{};
+    for (int type = 0; type < 7; ++type) {
+        for (int rotation = 0; rotation < 4; ++rotation) {
+            PieceMask mask{{{0, 0, 0, 0}}, 4, -1, 4, -1, {{-1, -1, -1, -1}}};
+            for (int by = 0; by < 4; ++by) {
+                for (int bx = 0; bx < 4; ++bx) {
+                    if (!shapes[type][rotation][by][bx]) continue;
+                    mask.rows[by] |= static_cast<uint16_t>(1u << bx);
+                    if (bx < mask.minX) mask.minX = static_cast<int8_t>(bx);
+                    if (bx > mask.maxX) mask.maxX = static_cast<int8_t>(bx);
+                    if (by < mask.minY) mask.minY = static_cast<int8_t>(by);
+                    if (by > mask.maxY) mask.maxY = static_cast<int8_t>(by);
+                    mask.bottom[bx] = static_cast<int8_t>(by);
+                }
+            }
+            masks[type][rotation] = mask;
+        }
+    }
+    return masks;
+}
+
+inline constexpr PieceMaskTable PIECE_MASKS = buildPieceMasks(PIECE_SHAPES);
@@ -0,0 +1,144 @@
+#include "Policy.hpp"
+#include <algorithm>
+#include <array>
+#include <random>
+
+namespace {
+
+class RandomPolicy : public Policy {
+public:
+    explicit RandomPolicy(uint32_t seed) : gen_(seed) {}
+
+    InputAction nextAction(const GameState&) override {
+        std::uniform_int_distribution<> dis(static_cast<int>(InputAction::NONE),
+                                            static_cast<int>(InputAction::HARD_DROP));
+        return static_cast<InputAction>(dis(gen_));
+    }
+
+private:
+    std::mt19937 gen_;
+};
+
+class DropPolicy : public Policy {
+public:
+    explicit DropPolicy(uint32_t seed) : gen_(seed), piece_(-1), targetRotation_(0), targetX_(0), moves_(0) {}
+
+    InputAction nextAction(const GameState& state) override {
+        const Piece& piece = state.current;
+        if (state.pieces != piece_) {
+            piece_ = state.pieces;
+            targetRotation_ = std::uniform_int_distribution<>(0, 3)(gen_);
+            targetX_ = std::uniform_int_distribution<>(-2, Board::WIDTH - 1)(gen_);
+            moves_ = 0;
+        }
+
+        // Kicks and walls can make a target unreachable, so give up after
+        // enough moves to cross the board and drop wherever the piece is.
+        if (++moves_ > MAX_MOVES) return InputAction::HARD_DROP;
+
+        if (piece.getRotation() != targetRotation_) return InputAction::ROTATE_CW;
+        if (piece.getX() > targetX_) return InputAction::MOVE_LEFT;
+        if (piece.getX() < targetX_) return InputAction::MOVE_RIGHT;
+        return InputAction::HARD_DROP;
+    }
+
+private:
+    static constexpr int MAX_MOVES = 16;
+
+    std::mt19937 gen_;
+    int piece_;
+    int targetRotation_;
+    int targetX_;
+    int moves_;
+};
+
+// Plays the bot's choice for each piece. Gravity can pull the piece off
+// the planned path between actions, in which case the path is searched
+// again from wherever the piece is now.
+class BotPolicy : public Policy {
+public:
+    explicit BotPolicy(const BotConfig& config) : bot_(config), piece_(-1), next_(0) {
+        path_.reserve(64);
+    }
+
+    InputAction nextAction(const GameState& state) override {
+        const Piece& piece = state.current;
+        bool instantGravity = state.level >= rules::INSTANT_GRAVITY_LEVEL;
+        bot_.moveGenerator().setInstantGravity(instantGravity);
+        if (state.pieces != piece_) {
+            piece_ = state.pieces;
+            chooseTarget(state);
+        } else if (!samePosition(piece, expected_)) {
+            planPath(state);
+        }
+
+        if (target_.getType() == PieceType::NONE || next_ >= path_.size()) {
+            return InputAction::HARD_DROP;
+        }
+
+        InputAction action = path_[next_++];
+        expected_ = piece;
+        switch (action) {
+            case InputAction::MOVE_LEFT:  rules::tryMove(state.board, expected_, -1, 0); break;
+            case InputAction::MOVE_RIGHT: rules::tryMove(state.board, expected_, 1, 0); break;
+            case InputAction::MOVE_DOWN:  rules::tryMove(state.board, expected_, 0, 1); break;
+            case InputAction::ROTATE_CW:  rules::tryRotate(state.board, expected_, 1, instantGravity); break;
+            case InputAction::ROTATE_CCW: rules::tryRotate(state.board, expected_, -1, instantGravity); break;
+            default: break;
+        }
+        if (instantGravity) expected_.move(0, rules::dropDistance(state.board, expected_));
+        return action;
+    }
+
+private:
+    static bool samePosition(const Piece& a, const Piece& b) {
+        return a.getX() == b.getX() && a.getY() == b.getY() && a.getRotation() == b.getRotation();
+    }
+
+    // Current piece followed by as much preview as the search depth uses
+    int lookahead(const GameState& state) {
+        int count = std::min(bot_.config().depth, 1 + PieceGenerator::MAX_PREVIEW);
+        pieces_[0] = state.current;
+        for (int i = 1; i < count; ++i) {
+            pieces_[i] = rules::preview(state, i - 1);
+        }
+        return count;
+    }
+
+    void chooseTarget(const GameState& state) {
+        target_ = bot_.choose(state.board, pieces_.data(), lookahead(state));
+        planPath(state);
+    }
+
+    void planPath(const GameState& state) {
+        next_ = 0;
+        expected_ = state.current;
+        if (target_.getType() == PieceType::NONE) return;
+
+        if (!bot_.moveGenerator().findPath(state.board, state.current, target_, path_)) {
+            // The target fell out of reach, so pick again from here
+            target_ = bot_.choose(state.board, pieces_.data(), lookahead(state));
+            if (target_.getType() == PieceType::NONE ||
+                !bot_.moveGenerator().findPath(state.board, state.current, target_, path_)) {
+                path_.clear();
+            }
+        }
+    }
+
+    Bot bot_;
+    std::array<Piece, 1 + PieceGenerator::MAX_PREVIEW> pieces_;
+    std::vector<InputAction> path_;
+    Piece target_;
+    Piece expected_;
+    int piece_;
+    size_t next_;
+};
+
+} // namespace
+
+std::unique_ptr<Policy> createPolicy(const std::string& name, uint32_t seed, const BotConfig& bot) {
+    if (name == "random") return std::make_unique<RandomPolicy>(seed);
+    if (name == "drop") return std::make_unique<DropPolicy>(seed);
+    if (name == "bot") return std::make_unique<BotPolicy>(bot);
+    return nullptr;
+}
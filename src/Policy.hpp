@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "Bot.hpp"
+#include "Rules.hpp"
+
+// Chooses the player's action for each tick. A policy instance drives a
+// single game, so implementations may keep per-game state without locking.
+class Policy {
+public:
+    virtual ~Policy() = default;
+
+    virtual InputAction nextAction(const GameState& state) = 0;
+};
+
+// Known names: "random" (random key presses), "drop" (random rotation and
+// column, then hard drop), "bot" (placement search, configured by bot).
+// Returns nullptr for an unknown name.
+std::unique_ptr<Policy> createPolicy(const std::string& name, uint32_t seed,
+                                     const BotConfig& bot = BotConfig());
@@ -1,22 +1,59 @@
 #include "Renderer.hpp"
+#include "Trace.hpp"
 #include <algorithm>
+#include <cstdio>
 #include <cstring>
 
-Renderer::Renderer() : renderer_(nullptr), window_(nullptr), font_(nullptr) {}
+namespace {
+
+// FNV-1a, used to look static strings up without building a std::string
+uint64_t hashText(const char* text) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* c = text; *c; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+Renderer::Renderer()
+    : renderer_(nullptr)
+    , window_(nullptr)
+    , font_(nullptr)
+    , glyphAtlas_(nullptr)
+    , glyphs_{}
+    , backgroundLayer_(nullptr)
+    , boardLayer_(nullptr)
+    , layerGeneration_(0) {}
 
 Renderer::~Renderer() {
     shutdown();
 }
 
-bool Renderer::initialize(SDL_Window* window) {
+bool Renderer::initialize(SDL_Window* window, bool vsync) {
     window_ = window;
-    renderer_ = SDL_CreateRenderer(window_, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    Uint32 flags = SDL_RENDERER_ACCELERATED;
+    if (vsync) flags |= SDL_RENDERER_PRESENTVSYNC;
+    renderer_ = SDL_CreateRenderer(window_, -1, flags);
+    if (!renderer_) {
+        return false;
+    }
+    return setup();
+}
+
+bool Renderer::initializeOffscreen(SDL_Surface* target) {
+    renderer_ = SDL_CreateSoftwareRenderer(target);
     if (!renderer_) {
         return false;
     }
+    return setup();
+}
 
+bool Renderer::setup() {
     if (TTF_Init() < 0) {
         SDL_DestroyRenderer(renderer_);
+        renderer_ = nullptr;
         return false;
     }
 
@@ -30,10 +67,74 @@ bool Renderer::initialize(SDL_Window* window) {
     }
 
     SDL_SetRenderDrawBlendMode(renderer_, SDL_BLENDMODE_BLEND);
+    buildGlyphAtlas();
+    batchVertices_.reserve(BATCH_RESERVE_QUADS * 4);
+    batchIndices_.reserve(BATCH_RESERVE_QUADS * 6);
+    createLayers();
     return true;
 }
 
+void Renderer::buildGlyphAtlas() {
+    if (!font_) return;
+
+    SDL_Color white = {255, 255, 255, 255};
+    std::array<SDL_Surface*, LAST_GLYPH - FIRST_GLYPH + 1> surfaces{};
+    int cellWidth = 1;
+    int cellHeight = 1;
+    for (size_t i = 0; i < surfaces.size(); ++i) {
+        Uint16 ch = static_cast<Uint16>(FIRST_GLYPH + i);
+        surfaces[i] = TTF_RenderGlyph_Blended(font_, ch, white);
+        int minX, maxX, minY, maxY;
+        if (TTF_GlyphMetrics(font_, ch, &minX, &maxX, &minY, &maxY, &glyphs_[i].advance) < 0) {
+            glyphs_[i].advance = surfaces[i] ? surfaces[i]->w : 0;
+        }
+        if (surfaces[i]) {
+            cellWidth = std::max(cellWidth, surfaces[i]->w);
+            cellHeight = std::max(cellHeight, surfaces[i]->h);
+        }
+    }
+
+    // Lay the glyphs out on a 16-column grid in a single surface
+    const int columns = 16;
+    const int rows = static_cast<int>((surfaces.size() + columns - 1) / columns);
+    SDL_Surface* atlas = SDL_CreateRGBSurfaceWithFormat(0, columns * cellWidth, rows * cellHeight,
+                                                        32, SDL_PIXELFORMAT_RGBA32);
+    for (size_t i = 0; i < surfaces.size(); ++i) {
+        SDL_Surface* glyph = surfaces[i];
+        if (!glyph) {
+            glyphs_[i].source = {0, 0, 0, 0};
+            continue;
+        }
+        SDL_Rect dst = {static_cast<int>(i % columns) * cellWidth,
+                        static_cast<int>(i / columns) * cellHeight,
+                        glyph->w, glyph->h};
+        glyphs_[i].source = dst;
+        if (atlas) {
+            SDL_SetSurfaceBlendMode(glyph, SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyph, nullptr, atlas, &dst);
+        }
+        SDL_FreeSurface(glyph);
+    }
+
+    if (atlas) {
+        glyphAtlas_ = SDL_CreateTextureFromSurface(renderer_, atlas);
+        if (glyphAtlas_) {
+            SDL_SetTextureBlendMode(glyphAtlas_, SDL_BLENDMODE_BLEND);
+        }
+        SDL_FreeSurface(atlas);
+    }
+}
+
 void Renderer::shutdown() {
+    destroyLayers();
+    for (auto& entry : textCache_) {
+        SDL_DestroyTexture(entry.second.texture);
+    }
+    textCache_.clear();
+    if (glyphAtlas_) {
+        SDL_DestroyTexture(glyphAtlas_);
+        glyphAtlas_ = nullptr;
+    }
     if (font_) {
         TTF_CloseFont(font_);
         font_ = nullptr;
@@ -46,40 +147,248 @@ void Renderer::shutdown() {
 }
 
 void Renderer::clear() {
-    SDL_SetRenderDrawColor(renderer_, 20, 20, 20, 255);
+    SDL_SetRenderDrawColor(renderer_, layout::BACKGROUND.r, layout::BACKGROUND.g, layout::BACKGROUND.b, 255);
     SDL_RenderClear(renderer_);
 }
 
 void Renderer::present() {
+    TRACE_SCOPE("Renderer::present");
+    // Cells queued outside drawGame still reach the screen
+    flushBatch();
     SDL_RenderPresent(renderer_);
 }
 
-void Renderer::drawBoard(const Board& board) {
-    // Draw border
+void Renderer::drawGame(const GameState& state) {
+    TRACE_SCOPE("Renderer::drawGame");
+    if (layersReady()) {
+        // Static background and locked cells come from cached textures
+        SDL_RenderCopy(renderer_, backgroundLayer_, nullptr, nullptr);
+        updateBoardLayer(state.board);
+        SDL_Rect boardRect = {GRID_OFFSET_X, GRID_OFFSET_Y, BOARD_LAYER_WIDTH, BOARD_LAYER_HEIGHT};
+        SDL_RenderCopy(renderer_, boardLayer_, nullptr, &boardRect);
+    } else {
+        drawBackground();
+        drawBoard(state.board);
+    }
+    
+    // Draw ghost piece
+    if (state.status == GameStatus::PLAYING) {
+        Piece ghost = state.current;
+        ghost.move(0, rules::dropDistance(state.board, ghost));
+        drawPiece(ghost, state.board, true);
+    }
+    
+    // Draw current piece
+    drawPiece(state.current, state.board, false);
+    
+    // Draw next piece
+    drawNextPiece(rules::preview(state));
+    
+    // Ghost, current and next piece go out in one submission, under the text
+    flushBatch();
+    
+    // Draw UI
+    drawUI(state.score, state.level, state.linesCleared);
+    
+    // Draw overlays
+    if (state.status == GameStatus::GAME_OVER) {
+        drawGameOver();
+    } else if (state.status == GameStatus::PAUSED) {
+        drawPaused();
+    }
+}
+
+void Renderer::drawWall(const MultiGame& games) {
+    TRACE_SCOPE("Renderer::drawWall");
+    const layout::WallLayout wall = layout::wallLayout(games.size());
+    
+    // Flat quads only, so hundreds of boards still go out in one submission
+    for (int i = 0; i < games.size(); ++i) {
+        drawWallBoard(wall, i, games.board(i), games.current(i), games.status(i));
+    }
+    flushBatch();
+    
+    if (wall.labels) {
+        char buffer[32];
+        for (int i = 0; i < games.size(); ++i) {
+            snprintf(buffer, sizeof(buffer), "%d", games.score(i));
+            drawText(buffer, wall.boardX(i), wall.boardY(i) + Board::HEIGHT * wall.cellSize + 4);
+        }
+    }
+}
+
+void Renderer::drawVersus(const VersusState& match, int localPlayer) {
+    TRACE_SCOPE("Renderer::drawVersus");
+    const layout::WallLayout wall = layout::wallLayout(VersusState::PLAYERS);
+    const SDL_Color meterColor = {layout::GARBAGE_METER.r, layout::GARBAGE_METER.g, layout::GARBAGE_METER.b, 255};
+    
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        const GameState& player = match.players[i];
+        drawWallBoard(wall, i, player.board, player.current, player.status);
+        
+        // Incoming garbage as a bar rising along the board's left edge
+        int rows = std::min(match.pendingGarbage[i], Board::HEIGHT);
+        int height = rows * wall.cellSize;
+        batchRect(wall.boardX(i) - layout::GARBAGE_METER_WIDTH - 1,
+                  wall.boardY(i) + Board::HEIGHT * wall.cellSize - height,
+                  layout::GARBAGE_METER_WIDTH, height, meterColor);
+    }
+    flushBatch();
+    
+    char buffer[32];
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        snprintf(buffer, sizeof(buffer), i == localPlayer ? "YOU %d" : "%d", match.players[i].score);
+        drawText(buffer, wall.boardX(i), wall.boardY(i) + Board::HEIGHT * wall.cellSize + 4);
+    }
+    if (match.finished) {
+        const char* result = match.winner < 0 ? "DRAW" : match.winner == localPlayer ? "YOU WIN" : "YOU LOSE";
+        drawText(result, WINDOW_WIDTH / 2 - 30, wall.originY / 2);
+    }
+}
+
+void Renderer::drawWallBoard(const layout::WallLayout& wall, int index, const Board& board,
+                             const Piece& piece, GameStatus status) {
+    const int cell = wall.cellSize;
+    // Cells keep a 1px gap once they are big enough to show it
+    const int fill = cell >= 4 ? cell - 1 : cell;
+    const int originX = wall.boardX(index);
+    const int originY = wall.boardY(index);
+    
+    batchRect(originX, originY, Board::WIDTH * cell, Board::HEIGHT * cell,
+              {layout::WALL_BOARD.r, layout::WALL_BOARD.g, layout::WALL_BOARD.b, 255});
+    for (int y = 0; y < Board::HEIGHT; ++y) {
+        const std::array<uint8_t, Board::WIDTH>& colors = board.getRowColors(y + Board::HIDDEN_ROWS);
+        for (uint32_t bits = board.getRow(y + Board::HIDDEN_ROWS); bits != 0; bits &= bits - 1) {
+            int x = __builtin_ctz(bits);
+            auto [r, g, b] = layout::CELL_COLORS[colors[x]];
+            batchRect(originX + x * cell, originY + y * cell, fill, fill, {r, g, b, 255});
+        }
+    }
+    
+    auto [r, g, b] = layout::CELL_COLORS[piece.getColor()];
+    for (const auto& [x, y] : piece.getBlocks()) {
+        if (y < Board::HIDDEN_ROWS) continue;
+        batchRect(originX + x * cell, originY + (y - Board::HIDDEN_ROWS) * cell, fill, fill, {r, g, b, 255});
+    }
+    
+    if (status == GameStatus::GAME_OVER) {
+        batchRect(originX, originY, Board::WIDTH * cell, Board::HEIGHT * cell, {0, 0, 0, layout::OVERLAY_ALPHA});
+    }
+}
+
+void Renderer::drawBackground() {
+    // Board border
     drawRect(GRID_OFFSET_X - 2, GRID_OFFSET_Y - 2, 
              Board::WIDTH * CELL_SIZE + 4, Board::HEIGHT * CELL_SIZE + 4,
-             100, 100, 100);
+             layout::BORDER.r, layout::BORDER.g, layout::BORDER.b);
     
+    // Preview box
+    drawRect(PREVIEW_OFFSET_X - 5, PREVIEW_OFFSET_Y - 30, 120, 130,
+             layout::PREVIEW_BOX.r, layout::PREVIEW_BOX.g, layout::PREVIEW_BOX.b);
+    
+    // Panel headings and controls
+    for (const layout::Label& label : layout::STATIC_LABELS) {
+        drawStaticText(label.text, label.x, label.y);
+    }
+}
+
+void Renderer::drawBoard(BoardView board) {
+    TRACE_SCOPE("Renderer::drawBoard");
+    drawBoardCells(board, GRID_OFFSET_X, GRID_OFFSET_Y);
+}
+
+void Renderer::drawBoardCells(BoardView board, int offsetX, int offsetY) {
     // Draw grid cells
     for (int y = 0; y < Board::HEIGHT; ++y) {
         for (int x = 0; x < Board::WIDTH; ++x) {
             int color = board.getCell(x, y + Board::HIDDEN_ROWS);
-            drawCell(x, y, color, GRID_OFFSET_X, GRID_OFFSET_Y, false);
+            drawCell(x, y, color, offsetX, offsetY, false);
         }
     }
     
     // Draw grid lines
-    SDL_SetRenderDrawColor(renderer_, 50, 50, 50, 255);
+    SDL_Color lineColor = {layout::GRID_LINE.r, layout::GRID_LINE.g, layout::GRID_LINE.b, 255};
     for (int x = 0; x <= Board::WIDTH; ++x) {
-        int lineX = GRID_OFFSET_X + x * CELL_SIZE;
-        SDL_RenderDrawLine(renderer_, lineX, GRID_OFFSET_Y, 
-                          lineX, GRID_OFFSET_Y + Board::HEIGHT * CELL_SIZE);
+        batchRect(offsetX + x * CELL_SIZE, offsetY, 1, Board::HEIGHT * CELL_SIZE + 1, lineColor);
     }
     for (int y = 0; y <= Board::HEIGHT; ++y) {
-        int lineY = GRID_OFFSET_Y + y * CELL_SIZE;
-        SDL_RenderDrawLine(renderer_, GRID_OFFSET_X, lineY,
-                          GRID_OFFSET_X + Board::WIDTH * CELL_SIZE, lineY);
+        batchRect(offsetX, offsetY + y * CELL_SIZE, Board::WIDTH * CELL_SIZE + 1, 1, lineColor);
+    }
+    
+    flushBatch();
+}
+
+void Renderer::createLayers() {
+    backgroundLayer_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                         WINDOW_WIDTH, WINDOW_HEIGHT);
+    boardLayer_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                    BOARD_LAYER_WIDTH, BOARD_LAYER_HEIGHT);
+    if (!backgroundLayer_ || !boardLayer_ || SDL_SetRenderTarget(renderer_, backgroundLayer_) < 0) {
+        // No render-target support, every frame is drawn from scratch
+        destroyLayers();
+        return;
+    }
+    
+    clear();
+    drawBackground();
+    SDL_SetRenderTarget(renderer_, nullptr);
+    SDL_SetTextureBlendMode(backgroundLayer_, SDL_BLENDMODE_NONE);
+    SDL_SetTextureBlendMode(boardLayer_, SDL_BLENDMODE_NONE);
+    layerGeneration_ = 0;
+}
+
+void Renderer::destroyLayers() {
+    if (backgroundLayer_) {
+        SDL_DestroyTexture(backgroundLayer_);
+        backgroundLayer_ = nullptr;
+    }
+    if (boardLayer_) {
+        SDL_DestroyTexture(boardLayer_);
+        boardLayer_ = nullptr;
     }
+    layerGeneration_ = 0;
+}
+
+void Renderer::restoreTextures(bool deviceLost) {
+    if (deviceLost) {
+        // The old textures belong to the lost device
+        for (auto& entry : textCache_) {
+            SDL_DestroyTexture(entry.second.texture);
+        }
+        textCache_.clear();
+        if (glyphAtlas_) {
+            SDL_DestroyTexture(glyphAtlas_);
+            glyphAtlas_ = nullptr;
+        }
+        buildGlyphAtlas();
+        destroyLayers();
+        createLayers();
+        return;
+    }
+    if (!layersReady()) return;
+    
+    SDL_SetRenderTarget(renderer_, backgroundLayer_);
+    clear();
+    drawBackground();
+    SDL_SetRenderTarget(renderer_, nullptr);
+    // The board layer is redrawn on the next drawGame
+    layerGeneration_ = 0;
+}
+
+void Renderer::updateBoardLayer(BoardView board) {
+    // Only locking a piece or clearing lines changes the board, so most
+    // frames reuse the texture as is
+    if (board.generation() == layerGeneration_) return;
+    
+    TRACE_SCOPE("Renderer::updateBoardLayer");
+    SDL_SetRenderTarget(renderer_, boardLayer_);
+    // The texture starts undefined and cells leave a gap around themselves,
+    // so the background goes down first as in a direct draw
+    SDL_SetRenderDrawColor(renderer_, layout::BACKGROUND.r, layout::BACKGROUND.g, layout::BACKGROUND.b, 255);
+    SDL_RenderClear(renderer_);
+    drawBoardCells(board, 0, 0);
+    SDL_SetRenderTarget(renderer_, nullptr);
+    layerGeneration_ = board.generation();
 }
 
 void Renderer::drawPiece(const Piece& piece, const Board& board, bool ghost) {
@@ -95,10 +404,6 @@ void Renderer::drawPiece(const Piece& piece, const Board& board, bool ghost) {
 }
 
 void Renderer::drawNextPiece(const Piece& piece) {
-    // Draw preview box
-    drawRect(PREVIEW_OFFSET_X - 5, PREVIEW_OFFSET_Y - 30, 120, 130, 80, 80, 80);
-    drawText("NEXT", PREVIEW_OFFSET_X + 35, PREVIEW_OFFSET_Y - 25);
-    
     // Center the piece in preview
     auto blocks = piece.getBlocks();
     if (blocks.empty()) return;
@@ -127,43 +432,68 @@ void Renderer::drawUI(int score, int level, int lines) {
     
     // Score
     snprintf(buffer, sizeof(buffer), "SCORE: %d", score);
-    drawText(buffer, PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 150);
+    drawText(buffer, PREVIEW_OFFSET_X, layout::SCORE_Y);
     
     // Level
     snprintf(buffer, sizeof(buffer), "LEVEL: %d", level);
-    drawText(buffer, PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 180);
+    drawText(buffer, PREVIEW_OFFSET_X, layout::LEVEL_Y);
     
     // Lines
     snprintf(buffer, sizeof(buffer), "LINES: %d", lines);
-    drawText(buffer, PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 210);
-    
-    // Controls
-    drawText("CONTROLS:", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 260);
-    drawText("Left/Right: Move", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 285);
-    drawText("Down: Soft Drop", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 305);
-    drawText("Up/Z: Rotate", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 325);
-    drawText("Space: Hard Drop", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 345);
-    drawText("P: Pause", PREVIEW_OFFSET_X, PREVIEW_OFFSET_Y + 365);
+    drawText(buffer, PREVIEW_OFFSET_X, layout::LINES_Y);
 }
 
 void Renderer::drawGameOver() {
     // Semi-transparent overlay
-    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 200);
-    SDL_Rect overlay = {0, 0, 600, 700};
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, layout::OVERLAY_ALPHA);
+    SDL_Rect overlay = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
     SDL_RenderFillRect(renderer_, &overlay);
     
-    drawText("GAME OVER", GRID_OFFSET_X + 60, 300);
-    drawText("Press P to restart", GRID_OFFSET_X + 50, 340);
+    for (const layout::Label& label : layout::GAME_OVER_LABELS) {
+        drawStaticText(label.text, label.x, label.y);
+    }
+}
+
+void Renderer::drawDemo() {
+    drawStaticText("DEMO - press B to play", GRID_OFFSET_X + 40, GRID_OFFSET_Y - 30);
+}
+
+void Renderer::drawFrameStats(const FrameStats& stats) {
+    const int rows = FrameStats::PHASE_COUNT + 2;
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, layout::OVERLAY_ALPHA);
+    SDL_Rect box = {layout::STATS_X, layout::STATS_Y, layout::STATS_WIDTH,
+                    rows * layout::STATS_ROW_HEIGHT + 8};
+    SDL_RenderFillRect(renderer_, &box);
+    
+    const char* headers[] = {"ms", "p50", "p99", "max"};
+    int y = layout::STATS_Y + 4;
+    for (int column = 0; column < 4; ++column) {
+        drawStaticText(headers[column], layout::STATS_COLUMNS[column], y);
+    }
+    
+    char buffer[16];
+    for (int phase = 0; phase <= FrameStats::FRAME; ++phase) {
+        y += layout::STATS_ROW_HEIGHT;
+        FrameStats::Summary summary = stats.summary(phase);
+        uint32_t values[] = {summary.p50, summary.p99, summary.max};
+        
+        drawStaticText(FrameStats::phaseName(phase), layout::STATS_COLUMNS[0], y);
+        for (int column = 0; column < 3; ++column) {
+            snprintf(buffer, sizeof(buffer), "%.2f", values[column] / 1000.0);
+            drawText(buffer, layout::STATS_COLUMNS[column + 1], y);
+        }
+    }
 }
 
 void Renderer::drawPaused() {
     // Semi-transparent overlay
-    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, 200);
-    SDL_Rect overlay = {0, 0, 600, 700};
+    SDL_SetRenderDrawColor(renderer_, 0, 0, 0, layout::OVERLAY_ALPHA);
+    SDL_Rect overlay = {0, 0, WINDOW_WIDTH, WINDOW_HEIGHT};
     SDL_RenderFillRect(renderer_, &overlay);
     
-    drawText("PAUSED", GRID_OFFSET_X + 80, 300);
-    drawText("Press P to resume", GRID_OFFSET_X + 40, 340);
+    for (const layout::Label& label : layout::PAUSED_LABELS) {
+        drawStaticText(label.text, label.x, label.y);
+    }
 }
 
 void Renderer::drawCell(int x, int y, int color, int offsetX, int offsetY, bool ghost) {
@@ -171,34 +501,65 @@ void Renderer::drawCell(int x, int y, int color, int offsetX, int offsetY, bool
     int drawY = offsetY + y * CELL_SIZE + 1;
     int size = CELL_SIZE - 2;
     
-    auto [r, g, b] = colors_[color];
+    auto [r, g, b] = layout::CELL_COLORS[color];
     
     if (ghost) {
         // Ghost piece is semi-transparent
-        SDL_SetRenderDrawColor(renderer_, r, g, b, 80);
-        SDL_Rect rect = {drawX, drawY, size, size};
-        SDL_RenderFillRect(renderer_, &rect);
+        batchRect(drawX, drawY, size, size, {r, g, b, layout::GHOST_FILL_ALPHA});
         
-        SDL_SetRenderDrawColor(renderer_, r, g, b, 150);
-        SDL_RenderDrawRect(renderer_, &rect);
+        // Outline
+        SDL_Color outline = {r, g, b, layout::GHOST_OUTLINE_ALPHA};
+        batchRect(drawX, drawY, size, 1, outline);
+        batchRect(drawX, drawY + size - 1, size, 1, outline);
+        batchRect(drawX, drawY + 1, 1, size - 2, outline);
+        batchRect(drawX + size - 1, drawY + 1, 1, size - 2, outline);
     } else {
-        // Normal piece with gradient effect
-        SDL_SetRenderDrawColor(renderer_, r, g, b, 255);
-        SDL_Rect rect = {drawX, drawY, size, size};
-        SDL_RenderFillRect(renderer_, &rect);
-        
-        // Highlight
-        SDL_SetRenderDrawColor(renderer_, std::min(255, r + 40), std::min(255, g + 40), std::min(255, b + 40), 255);
-        SDL_Rect highlight = {drawX, drawY, size, 3};
-        SDL_RenderFillRect(renderer_, &highlight);
-        
-        // Shadow
-        SDL_SetRenderDrawColor(renderer_, r * 0.7, g * 0.7, b * 0.7, 255);
-        SDL_Rect shadow = {drawX, drawY + size - 3, size, 3};
-        SDL_RenderFillRect(renderer_, &shadow);
+        // Normal piece with gradient effect: highlight, body, shadow bands
+        SDL_Color highlight = {Uint8(std::min(255, r + 40)), Uint8(std::min(255, g + 40)),
+                               Uint8(std::min(255, b + 40)), 255};
+        SDL_Color shadow = {Uint8(r * 0.7), Uint8(g * 0.7), Uint8(b * 0.7), 255};
+        batchRect(drawX, drawY, size, 3, highlight);
+        batchRect(drawX, drawY + 3, size, size - 6, {r, g, b, 255});
+        batchRect(drawX, drawY + size - 3, size, 3, shadow);
     }
 }
 
+void Renderer::batchRect(int x, int y, int w, int h, SDL_Color color) {
+    int base = static_cast<int>(batchVertices_.size());
+    float left = float(x), top = float(y), right = float(x + w), bottom = float(y + h);
+    batchVertices_.push_back({{left, top}, color, {0.0f, 0.0f}});
+    batchVertices_.push_back({{right, top}, color, {0.0f, 0.0f}});
+    batchVertices_.push_back({{right, bottom}, color, {0.0f, 0.0f}});
+    batchVertices_.push_back({{left, bottom}, color, {0.0f, 0.0f}});
+    
+    const int quad[6] = {0, 1, 2, 0, 2, 3};
+    for (int i : quad) {
+        batchIndices_.push_back(base + i);
+    }
+}
+
+void Renderer::flushBatch() {
+    if (batchVertices_.empty()) return;
+    
+    if (SDL_RenderGeometry(renderer_, nullptr, batchVertices_.data(), int(batchVertices_.size()),
+                           batchIndices_.data(), int(batchIndices_.size())) < 0) {
+        // Geometry unsupported by this renderer, fill the quads one by one
+        for (size_t i = 0; i < batchVertices_.size(); i += 4) {
+            const SDL_Vertex& topLeft = batchVertices_[i];
+            const SDL_Vertex& bottomRight = batchVertices_[i + 2];
+            SDL_SetRenderDrawColor(renderer_, topLeft.color.r, topLeft.color.g,
+                                   topLeft.color.b, topLeft.color.a);
+            SDL_Rect rect = {int(topLeft.position.x), int(topLeft.position.y),
+                             int(bottomRight.position.x - topLeft.position.x),
+                             int(bottomRight.position.y - topLeft.position.y)};
+            SDL_RenderFillRect(renderer_, &rect);
+        }
+    }
+    
+    batchVertices_.clear();
+    batchIndices_.clear();
+}
+
 void Renderer::drawRect(int x, int y, int w, int h, Uint8 r, Uint8 g, Uint8 b) {
     SDL_SetRenderDrawColor(renderer_, r, g, b, 255);
     SDL_Rect rect = {x, y, w, h};
@@ -206,31 +567,65 @@ void Renderer::drawRect(int x, int y, int w, int h, Uint8 r, Uint8 g, Uint8 b) {
 }
 
 void Renderer::drawText(const char* text, int x, int y) {
-    if (!font_) {
-        // Fallback: draw simple rectangles if font not loaded
-        SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 255);
-        int startX = x;
-        for (const char* c = text; *c; ++c) {
-            if (*c == ' ') {
-                startX += 10;
-                continue;
-            }
-            SDL_Rect charRect = {startX, y, 6, 10};
-            SDL_RenderFillRect(renderer_, &charRect);
-            startX += 10;
-        }
+    TRACE_SCOPE("Renderer::drawText");
+    if (!glyphAtlas_) {
+        drawFallbackText(text, x, y);
         return;
     }
 
-    SDL_Color white = {255, 255, 255, 255};
-    SDL_Surface* surface = TTF_RenderText_Solid(font_, text, white);
-    if (surface) {
-        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
-        if (texture) {
-            SDL_Rect dstRect = {x, y, surface->w, surface->h};
-            SDL_RenderCopy(renderer_, texture, nullptr, &dstRect);
-            SDL_DestroyTexture(texture);
+    int penX = x;
+    for (const char* c = text; *c; ++c) {
+        if (*c < FIRST_GLYPH || *c > LAST_GLYPH) continue;
+        const Glyph& glyph = glyphs_[*c - FIRST_GLYPH];
+        if (glyph.source.w > 0) {
+            SDL_Rect dstRect = {penX, y, glyph.source.w, glyph.source.h};
+            SDL_RenderCopy(renderer_, glyphAtlas_, &glyph.source, &dstRect);
         }
+        penX += glyph.advance;
+    }
+}
+
+void Renderer::drawStaticText(const char* text, int x, int y) {
+    uint64_t key = hashText(text);
+    auto it = textCache_.find(key);
+    if (it == textCache_.end() || it->second.text != text) {
+        if (!font_) {
+            drawFallbackText(text, x, y);
+            return;
+        }
+
+        SDL_Color white = {255, 255, 255, 255};
+        SDL_Surface* surface = TTF_RenderText_Blended(font_, text, white);
+        if (!surface) return;
+        SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer_, surface);
+        CachedText entry{text, texture, surface->w, surface->h};
         SDL_FreeSurface(surface);
+        if (!texture) return;
+
+        if (it != textCache_.end()) {
+            // Hash collision: the newer string takes over the slot
+            SDL_DestroyTexture(it->second.texture);
+            it->second = entry;
+        } else {
+            it = textCache_.emplace(key, entry).first;
+        }
+    }
+
+    SDL_Rect dstRect = {x, y, it->second.width, it->second.height};
+    SDL_RenderCopy(renderer_, it->second.texture, nullptr, &dstRect);
+}
+
+void Renderer::drawFallbackText(const char* text, int x, int y) {
+    // Fallback: draw simple rectangles if font not loaded
+    SDL_SetRenderDrawColor(renderer_, 255, 255, 255, 255);
+    int startX = x;
+    for (const char* c = text; *c; ++c) {
+        if (*c == ' ') {
+            startX += 10;
+            continue;
+        }
+        SDL_Rect charRect = {startX, y, 6, 10};
+        SDL_RenderFillRect(renderer_, &charRect);
+        startX += 10;
     }
 }
@@ -2,50 +2,125 @@
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "Board.hpp"
+#include "FrameStats.hpp"
+#include "Layout.hpp"
+#include "MultiGame.hpp"
 #include "Piece.hpp"
+#include "Rules.hpp"
+#include "Versus.hpp"
 
 class Renderer {
 public:
     Renderer();
     ~Renderer();
 
-    bool initialize(SDL_Window* window);
+    bool initialize(SDL_Window* window, bool vsync = true);
+    // Render into a surface with SDL's software renderer, no window needed
+    bool initializeOffscreen(SDL_Surface* target);
     void shutdown();
 
     void clear();
     void present();
 
-    void drawBoard(const Board& board);
+    // Board, ghost, pieces, side panel and overlay for one game state
+    void drawGame(const GameState& state);
+    
+    void drawBoard(BoardView board);
     void drawPiece(const Piece& piece, const Board& board, bool ghost = false);
     void drawNextPiece(const Piece& piece);
     void drawUI(int score, int level, int lines);
     void drawGameOver();
     void drawPaused();
+    void drawDemo();
+    // Every board of a multi-board game, scaled to fit the window
+    void drawWall(const MultiGame& games);
+    // Both boards of a netplay match with their incoming garbage
+    void drawVersus(const VersusState& match, int localPlayer);
+    // p50/p99/max of each frame phase over the last few seconds, in ms
+    void drawFrameStats(const FrameStats& stats);
+    // Redraw the cached layers after SDL_RENDER_TARGETS_RESET, or recreate
+    // every texture after SDL_RENDER_DEVICE_RESET
+    void restoreTextures(bool deviceLost);
 
-    static constexpr int CELL_SIZE = 30;
-    static constexpr int GRID_OFFSET_X = 50;
-    static constexpr int GRID_OFFSET_Y = 50;
-    static constexpr int PREVIEW_OFFSET_X = 400;
-    static constexpr int PREVIEW_OFFSET_Y = 100;
+    static constexpr int WINDOW_WIDTH = layout::WINDOW_WIDTH;
+    static constexpr int WINDOW_HEIGHT = layout::WINDOW_HEIGHT;
+    static constexpr int CELL_SIZE = layout::CELL_SIZE;
+    static constexpr int GRID_OFFSET_X = layout::GRID_OFFSET_X;
+    static constexpr int GRID_OFFSET_Y = layout::GRID_OFFSET_Y;
+    static constexpr int PREVIEW_OFFSET_X = layout::PREVIEW_OFFSET_X;
+    static constexpr int PREVIEW_OFFSET_Y = layout::PREVIEW_OFFSET_Y;
 
 private:
+    bool setup();
+    void buildGlyphAtlas();
+    
+    // Border, preview box and labels that never change
+    void drawBackground();
+    void drawBoardCells(BoardView board, int offsetX, int offsetY);
+    // Queues one board of a multi-board layout: cells, piece, game-over dim
+    void drawWallBoard(const layout::WallLayout& wall, int index, const Board& board,
+                       const Piece& piece, GameStatus status);
+    
+    void createLayers();
+    void destroyLayers();
+    bool layersReady() const { return backgroundLayer_ != nullptr; }
+    void updateBoardLayer(BoardView board);
+    // Queues a cell into the batch, nothing is drawn until flushBatch()
     void drawCell(int x, int y, int color, int offsetX, int offsetY, bool ghost = false);
+    void batchRect(int x, int y, int w, int h, SDL_Color color);
+    // Submits every queued quad with one SDL_RenderGeometry call
+    void flushBatch();
     void drawRect(int x, int y, int w, int h, Uint8 r, Uint8 g, Uint8 b);
+    // Text that changes between frames, drawn glyph by glyph from the atlas
     void drawText(const char* text, int x, int y);
+    // Fixed labels, rendered to a texture the first time they are drawn
+    void drawStaticText(const char* text, int x, int y);
+    void drawFallbackText(const char* text, int x, int y);
 
     SDL_Renderer* renderer_;
     SDL_Window* window_;
     TTF_Font* font_;
 
-    static constexpr std::array<std::tuple<Uint8, Uint8, Uint8>, 8> colors_ = {{
-        {128, 128, 128},  // 0: Empty (Gray)
-        {0, 255, 255},    // 1: I (Cyan)
-        {255, 255, 0},    // 2: O (Yellow)
-        {128, 0, 128},    // 3: T (Purple)
-        {0, 255, 0},      // 4: S (Green)
-        {255, 0, 0},      // 5: Z (Red)
-        {0, 0, 255},      // 6: J (Blue)
-        {255, 165, 0}     // 7: L (Orange)
-    }};
+    static constexpr char FIRST_GLYPH = ' ';
+    static constexpr char LAST_GLYPH = '~';
+
+    struct Glyph {
+        SDL_Rect source;    // position in glyphAtlas_
+        int advance;
+    };
+
+    struct CachedText {
+        std::string text;
+        SDL_Texture* texture;
+        int width;
+        int height;
+    };
+
+    SDL_Texture* glyphAtlas_;
+    std::array<Glyph, LAST_GLYPH - FIRST_GLYPH + 1> glyphs_;
+    // Keyed by a hash of the string, the stored text guards against collisions
+    std::unordered_map<uint64_t, CachedText> textCache_;
+
+    // Cell grid plus its closing grid lines
+    static constexpr int BOARD_LAYER_WIDTH = Board::WIDTH * CELL_SIZE + 1;
+    static constexpr int BOARD_LAYER_HEIGHT = Board::HEIGHT * CELL_SIZE + 1;
+
+    // Render-target textures, null when the renderer cannot draw to textures
+    SDL_Texture* backgroundLayer_;
+    SDL_Texture* boardLayer_;
+    // Board::generation() of the contents drawn into boardLayer_, 0 = none
+    uint64_t layerGeneration_;
+
+    // A full board is 3 quads per cell plus the grid lines
+    static constexpr int BATCH_RESERVE_QUADS = Board::WIDTH * Board::HEIGHT * 3 + 64;
+
+    // Solid-color quads, 4 vertices and 6 indices each
+    std::vector<SDL_Vertex> batchVertices_;
+    std::vector<int> batchIndices_;
 };
@@ -0,0 +1,187 @@
+#include "Replay.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+constexpr uint8_t MAGIC[4] = {'T', 'R', 'P', 'L'};
+constexpr uint8_t VERSION = 3;
+constexpr int ACTION_BITS = 4;
+
+static_assert(static_cast<int>(InputAction::DUMP_TRACE) < (1 << ACTION_BITS),
+              "actions must fit in the low bits of a record");
+
+void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (data == end) return false;
+        uint8_t byte = *data++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Reads a varint that must fit in 32 bits
+bool readVarint32(const uint8_t*& data, const uint8_t* end, uint32_t& value) {
+    uint64_t wide;
+    if (!readVarint(data, end, wide) || wide > UINT32_MAX) return false;
+    value = static_cast<uint32_t>(wide);
+    return true;
+}
+
+bool readInt(const uint8_t*& data, const uint8_t* end, int& value) {
+    uint32_t wide;
+    if (!readVarint32(data, end, wide) || wide > INT32_MAX) return false;
+    value = static_cast<int>(wide);
+    return true;
+}
+
+} // namespace
+
+ReplayTrailer makeTrailer(const GameState& state, uint32_t ticks) {
+    ReplayTrailer trailer;
+    trailer.score = state.score;
+    trailer.lines = state.linesCleared;
+    trailer.pieces = state.pieces;
+    trailer.ticks = ticks;
+    return trailer;
+}
+
+void ReplayRecorder::begin(uint32_t seed, Randomizer randomizer) {
+    replay_.seed = seed;
+    replay_.randomizer = randomizer;
+    replay_.records.clear();
+    // Room for a long session up front, so recording rarely has to grow it
+    replay_.records.reserve(INITIAL_RECORDS);
+    replay_.trailer = ReplayTrailer();
+    ticks_ = 0;
+}
+
+void ReplayRecorder::action(InputAction action) {
+    // NONE never changes the game, so it is not worth storing
+    if (action == InputAction::NONE) return;
+    replay_.records.push_back({ticks_, action});
+}
+
+const Replay& ReplayRecorder::finish(const GameState& state) {
+    replay_.trailer = makeTrailer(state, ticks_);
+    return replay_;
+}
+
+void ReplayPlayer::start(GameState& state) {
+    rules::reset(state, replay_.seed, replay_.randomizer);
+    next_ = 0;
+    tick_ = 0;
+    finished_ = false;
+}
+
+bool ReplayPlayer::step(GameState& state) {
+    if (finished_) return false;
+
+    const std::vector<ReplayRecord>& records = replay_.records;
+    while (next_ < records.size() && records[next_].tick == tick_) {
+        rules::applyAction(state, records[next_].action);
+        ++next_;
+    }
+
+    // Actions recorded after the last tick are applied above, then playback stops
+    if (tick_ >= replay_.trailer.ticks) {
+        finished_ = true;
+        return false;
+    }
+
+    rules::tick(state);
+    ++tick_;
+    return true;
+}
+
+ReplayTrailer playReplay(const Replay& replay) {
+    GameState state;
+    return playReplay(replay, state);
+}
+
+ReplayTrailer playReplay(const Replay& replay, GameState& state) {
+    ReplayPlayer player(replay);
+    player.start(state);
+    while (player.step(state)) {}
+    return makeTrailer(state, player.ticks());
+}
+
+std::vector<uint8_t> encodeReplay(const Replay& replay) {
+    std::vector<uint8_t> out(std::begin(MAGIC), std::end(MAGIC));
+    out.push_back(VERSION);
+    out.push_back(static_cast<uint8_t>(replay.randomizer));
+    // Most records are a byte or two: small tick gaps and a 4-bit action
+    out.reserve(out.size() + 16 + replay.records.size() * 2);
+
+    writeVarint(out, replay.seed);
+    writeVarint(out, replay.records.size());
+    uint32_t lastTick = 0;
+    for (const ReplayRecord& record : replay.records) {
+        uint64_t delta = record.tick - lastTick;
+        writeVarint(out, (delta << ACTION_BITS) | static_cast<uint64_t>(record.action));
+        lastTick = record.tick;
+    }
+
+    writeVarint(out, static_cast<uint32_t>(replay.trailer.score));
+    writeVarint(out, static_cast<uint32_t>(replay.trailer.lines));
+    writeVarint(out, static_cast<uint32_t>(replay.trailer.pieces));
+    writeVarint(out, replay.trailer.ticks);
+    return out;
+}
+
+bool decodeReplay(const uint8_t* data, size_t size, Replay& replay) {
+    const uint8_t* end = data + size;
+    if (size < sizeof(MAGIC) + 2 || !std::equal(std::begin(MAGIC), std::end(MAGIC), data) ||
+        data[sizeof(MAGIC)] != VERSION || data[sizeof(MAGIC) + 1] > static_cast<uint8_t>(Randomizer::BAG)) {
+        return false;
+    }
+    replay.randomizer = static_cast<Randomizer>(data[sizeof(MAGIC) + 1]);
+    data += sizeof(MAGIC) + 2;
+
+    uint64_t count;
+    if (!readVarint32(data, end, replay.seed) || !readVarint(data, end, count)) return false;
+    // Every record takes at least one byte, which bounds a corrupt count
+    if (count > static_cast<uint64_t>(end - data)) return false;
+
+    replay.records.clear();
+    replay.records.reserve(count);
+    uint64_t tick = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t packed;
+        if (!readVarint(data, end, packed)) return false;
+        uint64_t action = packed & ((1u << ACTION_BITS) - 1);
+        tick += packed >> ACTION_BITS;
+        if (action > static_cast<uint64_t>(InputAction::DUMP_TRACE) || tick > UINT32_MAX) return false;
+        replay.records.push_back({static_cast<uint32_t>(tick), static_cast<InputAction>(action)});
+    }
+
+    ReplayTrailer& trailer = replay.trailer;
+    return readInt(data, end, trailer.score) && readInt(data, end, trailer.lines) &&
+           readInt(data, end, trailer.pieces) && readVarint32(data, end, trailer.ticks) &&
+           data == end;
+}
+
+bool saveReplay(const std::string& path, const Replay& replay) {
+    std::vector<uint8_t> bytes = encodeReplay(replay);
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+bool loadReplay(const std::string& path, Replay& replay) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return decodeReplay(bytes.data(), bytes.size(), replay);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Rules.hpp"
+
+// One player action, applied before the tick with the same index
+struct ReplayRecord {
+    uint32_t tick;
+    InputAction action;
+};
+
+// Final state of the recorded game, checked on playback
+struct ReplayTrailer {
+    int score = 0;
+    int lines = 0;
+    int pieces = 0;
+    uint32_t ticks = 0;     // rules::tick calls made while recording
+
+    bool operator==(const ReplayTrailer& other) const {
+        return score == other.score && lines == other.lines &&
+               pieces == other.pieces && ticks == other.ticks;
+    }
+    bool operator!=(const ReplayTrailer& other) const { return !(*this == other); }
+};
+
+// Trailer describing state after ticks ticks of play
+ReplayTrailer makeTrailer(const GameState& state, uint32_t ticks);
+
+// A game is fully determined by its seed and the ordered actions and ticks
+// applied to it, so that is all a replay stores.
+struct Replay {
+    uint32_t seed = 0;
+    Randomizer randomizer = Randomizer::BAG;
+    std::vector<ReplayRecord> records;
+    ReplayTrailer trailer;
+};
+
+// Builds a Replay alongside a live game. Call action() for every action
+// handed to rules::applyAction and tick() for every rules::tick.
+class ReplayRecorder {
+public:
+    void begin(uint32_t seed, Randomizer randomizer);
+    void action(InputAction action);
+    void tick() { ++ticks_; }
+    // Fill in the trailer from the game as it stands now
+    const Replay& finish(const GameState& state);
+
+    const Replay& replay() const { return replay_; }
+
+private:
+    static constexpr size_t INITIAL_RECORDS = 4096;
+
+    Replay replay_;
+    uint32_t ticks_ = 0;
+};
+
+// Feeds a Replay back through the rules one tick at a time
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(const Replay& replay) : replay_(replay) {}
+
+    void start(GameState& state);
+    // Apply the actions due before the next tick, then tick. Returns false
+    // once every record and tick has been played.
+    bool step(GameState& state);
+    bool finished() const { return finished_; }
+    uint32_t ticks() const { return tick_; }
+
+private:
+    const Replay& replay_;
+    size_t next_ = 0;
+    uint32_t tick_ = 0;
+    bool finished_ = false;
+};
+
+// Play a replay headless at full speed and report how the game ended,
+// optionally leaving the final position in state
+ReplayTrailer playReplay(const Replay& replay);
+ReplayTrailer playReplay(const Replay& replay, GameState& state);
+
+// Binary format: "TRPL", version byte, randomizer byte, then LEB128 varints
+// for the seed, the record count, one (tick delta << 4 | action) per record, and the
+// trailer's score, lines, pieces and ticks.
+std::vector<uint8_t> encodeReplay(const Replay& replay);
+bool decodeReplay(const uint8_t* data, size_t size, Replay& replay);
+
+bool saveReplay(const std::string& path, const Replay& replay);
+bool loadReplay(const std::string& path, Replay& replay);
@@ -0,0 +1,155 @@
+#include "Rewind.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+
+// The board comes first in GameState; a delta stores everything after it
+// as is and only the changed rows of the board
+static_assert(offsetof(GameState, board) == 0, "delta layout assumes the board leads GameState");
+constexpr size_t BOARD_BYTES = offsetof(GameState, generator);
+constexpr size_t TAIL_BYTES = sizeof(GameState) - BOARD_BYTES;
+constexpr size_t ROW_BYTES = Board::WIDTH;
+static_assert(Board::TOTAL_ROWS <= 32, "changed rows are a 32-bit mask");
+
+constexpr size_t MIN_CAPACITY = 64 << 10;
+
+} // namespace
+
+RewindBuffer::RewindBuffer(size_t capacityBytes) {
+    // The capacity covers the entries and their index. An eighth goes to
+    // the index, enough for entries averaging about 100 bytes.
+    capacityBytes = std::min(std::max(capacityBytes, MIN_CAPACITY), MAX_CAPACITY);
+    size_t slotCount = capacityBytes / 8 / sizeof(Slot);
+    slots_.resize(slotCount);
+    bytes_.resize(capacityBytes - slotCount * sizeof(Slot));
+    clear();
+}
+
+void RewindBuffer::clear() {
+    oldest_ = 0;
+    next_ = 0;
+    writeOffset_ = 0;
+    bytesUsed_ = 0;
+    keyframeSequence_ = 0;
+}
+
+void RewindBuffer::push(const GameState& state) {
+    bool needKeyframe = size() == 0 || keyframeSequence_ < oldest_ ||
+                        next_ - keyframeSequence_ >= KEYFRAME_INTERVAL;
+    if (!needKeyframe) {
+        uint32_t changed = 0;
+        for (int y = 0; y < Board::TOTAL_ROWS; ++y) {
+            if (state.board.getRowColors(y) != keyframe_.board.getRowColors(y)) {
+                changed |= 1u << y;
+            }
+        }
+
+        size_t size = sizeof(changed) + TAIL_BYTES + __builtin_popcount(changed) * ROW_BYTES;
+        // Falls through to a keyframe when the delta would evict its own keyframe
+        if (uint8_t* out = allocate(size, true)) {
+            std::memcpy(out, &changed, sizeof(changed));
+            out += sizeof(changed);
+            std::memcpy(out, reinterpret_cast<const uint8_t*>(&state) + BOARD_BYTES, TAIL_BYTES);
+            out += TAIL_BYTES;
+            for (uint32_t rows = changed; rows != 0; rows &= rows - 1) {
+                std::memcpy(out, state.board.getRowColors(__builtin_ctz(rows)).data(), ROW_BYTES);
+                out += ROW_BYTES;
+            }
+            commit(size, keyframeSequence_);
+            return;
+        }
+    }
+
+    uint8_t* out = allocate(sizeof(GameState), false);
+    std::memcpy(out, &state, sizeof(GameState));
+    keyframe_ = state;
+    keyframeSequence_ = next_;
+    commit(sizeof(GameState), next_);
+}
+
+bool RewindBuffer::undo(GameState& state, int steps) {
+    if (steps < 0 || static_cast<size_t>(steps) >= size()) return false;
+
+    uint64_t target = next_ - 1 - static_cast<uint64_t>(steps);
+    for (uint64_t sequence = target + 1; sequence < next_; ++sequence) {
+        bytesUsed_ -= slot(sequence).size;
+    }
+    next_ = target + 1;
+    writeOffset_ = slot(target).offset + slot(target).size;
+    restore(target, state);
+    return true;
+}
+
+uint8_t* RewindBuffer::allocate(size_t size, bool keepGroup) {
+    auto evict = [this, keepGroup] {
+        if (keepGroup && slot(oldest_).keyframe == keyframeSequence_) return false;
+        evictOldestGroup();
+        return true;
+    };
+
+    while (this->size() >= slots_.size()) {
+        if (!evict()) return nullptr;
+    }
+
+    // Entries are contiguous, so one that does not fit before the end of
+    // the ring starts over at 0. Whatever lies past the write position is
+    // from the previous lap and older than anything before it.
+    size_t offset = writeOffset_;
+    if (offset + size > bytes_.size()) {
+        while (this->size() > 0 && slot(oldest_).offset >= offset) {
+            if (!evict()) return nullptr;
+        }
+        offset = 0;
+    }
+    while (this->size() > 0) {
+        const Slot& oldest = slot(oldest_);
+        if (oldest.offset >= offset + size || oldest.offset + oldest.size <= offset) break;
+        if (!evict()) return nullptr;
+    }
+
+    writeOffset_ = offset;
+    return bytes_.data() + offset;
+}
+
+void RewindBuffer::commit(size_t size, uint64_t keyframe) {
+    Slot& entry = slot(next_);
+    entry.offset = static_cast<uint32_t>(writeOffset_);
+    entry.size = static_cast<uint32_t>(size);
+    entry.keyframe = keyframe;
+    writeOffset_ += size;
+    bytesUsed_ += size;
+    ++next_;
+}
+
+void RewindBuffer::evictOldestGroup() {
+    do {
+        bytesUsed_ -= slot(oldest_).size;
+        ++oldest_;
+    } while (oldest_ < next_ && slot(oldest_).keyframe != oldest_);
+}
+
+void RewindBuffer::restore(uint64_t sequence, GameState& state) {
+    const Slot& entry = slot(sequence);
+    if (entry.keyframe != keyframeSequence_) {
+        std::memcpy(&keyframe_, bytes_.data() + slot(entry.keyframe).offset, sizeof(GameState));
+        keyframeSequence_ = entry.keyframe;
+    }
+
+    state = keyframe_;
+    if (entry.keyframe == sequence) return;
+
+    const uint8_t* in = bytes_.data() + entry.offset;
+    uint32_t changed;
+    std::memcpy(&changed, in, sizeof(changed));
+    in += sizeof(changed);
+    std::memcpy(reinterpret_cast<uint8_t*>(&state) + BOARD_BYTES, in, TAIL_BYTES);
+    in += TAIL_BYTES;
+    for (uint32_t rows = changed; rows != 0; rows &= rows - 1) {
+        std::array<uint8_t, Board::WIDTH> colors;
+        std::memcpy(colors.data(), in, ROW_BYTES);
+        state.board.setRow(__builtin_ctz(rows), colors);
+        in += ROW_BYTES;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Rules.hpp"
+
+// Bounded history of game states for undo and hold-to-rewind. Every
+// KEYFRAME_INTERVAL-th entry is a full GameState; the rest store only the
+// board rows that differ from their keyframe plus the fields outside the
+// board (piece, generator, score, level, timers). Entries live in a byte
+// ring allocated once, and the oldest keyframe and its deltas are dropped
+// when it fills, so memory stays at the configured capacity.
+class RewindBuffer {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4 << 20;
+    // Entry offsets are 32-bit, so the ring stays below 4 GB
+    static constexpr size_t MAX_CAPACITY = size_t{4095} << 20;
+    static constexpr int KEYFRAME_INTERVAL = 32;
+
+    // capacityBytes covers the entries and their index, clamped to 64 KB
+    // to MAX_CAPACITY
+    explicit RewindBuffer(size_t capacityBytes = DEFAULT_CAPACITY);
+
+    void clear();
+    // Store state as the newest entry, typically once per locked piece
+    void push(const GameState& state);
+    // Restore the state steps entries before the newest and forget the
+    // entries after it. Returns false, leaving state untouched, when the
+    // history is not that long.
+    bool undo(GameState& state, int steps = 1);
+
+    // Entries held, the newest included; undo can go back size() - 1 steps
+    size_t size() const { return static_cast<size_t>(next_ - oldest_); }
+    size_t capacity() const { return bytes_.size() + slots_.size() * sizeof(Slot); }
+    // Bytes taken by the entries held
+    size_t bytesUsed() const { return bytesUsed_; }
+
+private:
+    struct Slot {
+        uint32_t offset;
+        uint32_t size;
+        uint64_t keyframe;  // sequence number of the keyframe it is relative to
+    };
+
+    Slot& slot(uint64_t sequence) { return slots_[sequence % slots_.size()]; }
+    // Reserve size contiguous bytes at the write position, evicting the
+    // oldest entries as needed. With keepGroup it gives up, returning null,
+    // rather than evict the group of the current keyframe.
+    uint8_t* allocate(size_t size, bool keepGroup);
+    // Record the bytes just written by allocate() as the newest entry
+    void commit(size_t size, uint64_t keyframe);
+    // Drop the oldest keyframe together with the deltas that depend on it
+    void evictOldestGroup();
+    void restore(uint64_t sequence, GameState& state);
+
+    std::vector<uint8_t> bytes_;
+    std::vector<Slot> slots_;
+    uint64_t oldest_;       // sequence number of the oldest entry held
+    uint64_t next_;         // sequence number the next push gets
+    size_t writeOffset_;
+    size_t bytesUsed_;
+
+    // Latest keyframe, kept unpacked so pushes can diff against it
+    GameState keyframe_;
+    uint64_t keyframeSequence_;
+};
@@ -0,0 +1,295 @@
+#include "Rules.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace rules {
+
+namespace {
+
+// The rules are written once against GameState's field names, so they run
+// the same on a GameState and on a GameRef into separate arrays.
+
+// Under 20G the piece falls all the way after it spawns or moves, and the
+// gravity timer becomes a lock delay that each successful move restarts
+template <typename State>
+void applyInstantGravity(State& state) {
+    if (state.level >= INSTANT_GRAVITY_LEVEL && state.status == GameStatus::PLAYING) {
+        state.current.move(0, dropDistance(state.board, state.current));
+        state.fallTimer = 0;
+    }
+}
+
+template <typename State>
+void spawnPiece(State& state) {
+    state.current = Piece(state.generator.pop());
+    ++state.pieces;
+
+    // Check if game over
+    if (!canPlace(state.board, state.current)) {
+        state.status = GameStatus::GAME_OVER;
+        return;
+    }
+    applyInstantGravity(state);
+}
+
+template <typename State>
+void restart(State& state) {
+    state.board.clear();
+    state.status = GameStatus::PLAYING;
+    state.score = 0;
+    state.level = 1;
+    state.linesCleared = 0;
+    state.pieces = 0;
+    state.fallInterval = INITIAL_FALL_INTERVAL;
+    spawnPiece(state);
+}
+
+// A bot game without a piece cap can run for days; the score stops at the
+// largest int rather than overflowing
+template <typename State>
+void addScore(State& state, int64_t points) {
+    int64_t total = static_cast<int64_t>(state.score) + points;
+    state.score = static_cast<int>(std::min<int64_t>(total, std::numeric_limits<int>::max()));
+}
+
+template <typename State>
+void updateScore(State& state, int lines) {
+    static const int lineScores[] = {0, 100, 300, 500, 800};
+    addScore(state, static_cast<int64_t>(lineScores[lines]) * state.level);
+    state.linesCleared += lines;
+}
+
+template <typename State>
+void updateLevel(State& state) {
+    int newLevel = 1 + state.linesCleared / 10;
+    if (newLevel > state.level) {
+        state.level = newLevel;
+        state.fallInterval = std::max(MIN_FALL_INTERVAL,
+                                      INITIAL_FALL_INTERVAL - (state.level - 1) * FALL_INTERVAL_STEP);
+    }
+}
+
+template <typename State>
+void lockPiece(State& state, StepResult& result) {
+    TRACE_SCOPE("rules::lockPiece");
+    const Piece& piece = state.current;
+    state.board.place(piece.getMask(), piece.getX(), piece.getY(), piece.getColor());
+    ++result.piecesLocked;
+
+    // Clear lines
+    {
+        TRACE_SCOPE("rules::clearLines");
+        int lines = state.board.clearLines();
+        if (lines > 0) {
+            updateScore(state, lines);
+            updateLevel(state);
+            result.linesCleared += lines;
+        }
+    }
+
+    spawnPiece(state);
+}
+
+// Move the current piece down one row, locking it if it cannot fall
+template <typename State>
+void stepDown(State& state, StepResult& result) {
+    if (!tryMove(state.board, state.current, 0, 1)) {
+        lockPiece(state, result);
+    }
+}
+
+template <typename State>
+void resetImpl(State& state, uint32_t seed, Randomizer randomizer) {
+    state.generator.reset(seed, randomizer);
+    state.fallTimer = 0;
+    restart(state);
+}
+
+template <typename State>
+StepResult applyActionImpl(State& state, InputAction action) {
+    StepResult result;
+
+    if (action == InputAction::PAUSE) {
+        if (state.status == GameStatus::GAME_OVER) {
+            restart(state);
+        } else {
+            state.status = (state.status == GameStatus::PAUSED) ? GameStatus::PLAYING : GameStatus::PAUSED;
+        }
+        return result;
+    }
+
+    if (state.status != GameStatus::PLAYING) return result;
+
+    switch (action) {
+        case InputAction::MOVE_LEFT:
+            if (tryMove(state.board, state.current, -1, 0)) applyInstantGravity(state);
+            break;
+
+        case InputAction::MOVE_RIGHT:
+            if (tryMove(state.board, state.current, 1, 0)) applyInstantGravity(state);
+            break;
+
+        case InputAction::MOVE_DOWN:
+            // A soft drop stands in for this row's gravity step, so the
+            // piece cannot be pulled down a second row right after it
+            stepDown(state, result);
+            state.fallTimer = 0;
+            addScore(state, 1);
+            break;
+
+        case InputAction::ROTATE_CW:
+            if (tryRotate(state.board, state.current, 1, state.level >= INSTANT_GRAVITY_LEVEL)) {
+                applyInstantGravity(state);
+            }
+            break;
+
+        case InputAction::ROTATE_CCW:
+            if (tryRotate(state.board, state.current, -1, state.level >= INSTANT_GRAVITY_LEVEL)) {
+                applyInstantGravity(state);
+            }
+            break;
+
+        case InputAction::HARD_DROP: {
+            int distance = dropDistance(state.board, state.current);
+            state.current.move(0, distance);
+            addScore(state, 2 * (distance + 1));
+            lockPiece(state, result);
+            break;
+        }
+
+        default:
+            break;
+    }
+    return result;
+}
+
+template <typename State>
+StepResult tickImpl(State& state) {
+    StepResult result;
+    if (state.status != GameStatus::PLAYING) return result;
+
+    if (++state.fallTimer >= state.fallInterval) {
+        state.fallTimer = 0;
+        stepDown(state, result);
+    }
+    return result;
+}
+
+} // namespace
+
+void save(const GameState& state, StateBlob& blob) {
+    std::memcpy(blob.data(), &state, sizeof(GameState));
+}
+
+void load(const StateBlob& blob, GameState& state) {
+    std::memcpy(&state, blob.data(), sizeof(GameState));
+}
+
+uint64_t hash(const GameState& state) {
+    const Piece& piece = state.current;
+    uint64_t fields[] = {
+        state.generator.hash(),
+        uint64_t(uint8_t(piece.getType())) | uint64_t(uint8_t(piece.getX())) << 8 |
+            uint64_t(uint8_t(piece.getY())) << 16 | uint64_t(piece.getRotation()) << 24 |
+            uint64_t(state.status) << 32,
+        uint64_t(uint32_t(state.score)) | uint64_t(uint32_t(state.level)) << 32,
+        uint64_t(uint32_t(state.linesCleared)) | uint64_t(uint32_t(state.pieces)) << 32,
+        uint64_t(uint32_t(state.fallTimer)) | uint64_t(uint32_t(state.fallInterval)) << 32,
+    };
+    uint64_t h = state.board.hash();
+    for (uint64_t field : fields) {
+        h = (h ^ field) * 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+void reset(GameState& state, uint32_t seed, Randomizer randomizer) {
+    resetImpl(state, seed, randomizer);
+}
+
+void reset(GameRef state, uint32_t seed, Randomizer randomizer) {
+    resetImpl(state, seed, randomizer);
+}
+
+StepResult applyAction(GameState& state, InputAction action) {
+    return applyActionImpl(state, action);
+}
+
+StepResult applyAction(GameRef state, InputAction action) {
+    return applyActionImpl(state, action);
+}
+
+StepResult tick(GameState& state) {
+    return tickImpl(state);
+}
+
+StepResult tick(GameRef state) {
+    return tickImpl(state);
+}
+
+StepResult step(GameState& state, InputAction action) {
+    StepResult result = applyAction(state, action);
+    StepResult ticked = tick(state);
+    result.piecesLocked += ticked.piecesLocked;
+    result.linesCleared += ticked.linesCleared;
+    return result;
+}
+
+void addGarbage(GameState& state, int lines, int hole) {
+    if (lines <= 0 || state.status != GameStatus::PLAYING) return;
+
+    // The piece never goes above row 0, where nothing can index its
+    // position; running out of room there is a top-out like any other
+    bool fits = state.board.addGarbage(lines, hole);
+    for (int lifted = 0; fits && !canPlace(state.board, state.current); ++lifted) {
+        if (lifted == lines || state.current.getY() == 0) fits = false;
+        else state.current.move(0, -1);
+    }
+    if (!fits) {
+        state.status = GameStatus::GAME_OVER;
+    }
+}
+
+bool canPlace(const Board& board, const Piece& piece) {
+    return board.canPlace(piece.getMask(), piece.getX(), piece.getY());
+}
+
+bool tryMove(const Board& board, Piece& piece, int dx, int dy) {
+    piece.move(dx, dy);
+    if (!canPlace(board, piece)) {
+        piece.move(-dx, -dy);
+        return false;
+    }
+    return true;
+}
+
+bool tryRotate(const Board& board, Piece& piece, int direction, bool floorKick) {
+    piece.rotate(direction);
+    if (canPlace(board, piece)) return true;
+
+    // Try wall kicks
+    piece.move(-1, 0);
+    if (canPlace(board, piece)) return true;
+    piece.move(2, 0);
+    if (canPlace(board, piece)) return true;
+    piece.move(-1, 0);
+
+    // Then one row up, never above row 0
+    if (floorKick && piece.getY() > 0) {
+        piece.move(0, -1);
+        if (canPlace(board, piece)) return true;
+        piece.move(0, 1);
+    }
+
+    piece.rotate(-direction);
+    return false;
+}
+
+int dropDistance(const Board& board, const Piece& piece) {
+    return board.dropDistance(piece.getMask(), piece.getX(), piece.getY());
+}
+
+} // namespace rules
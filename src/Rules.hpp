@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include "Board.hpp"
+#include "InputAction.hpp"
+#include "Piece.hpp"
+#include "PieceGenerator.hpp"
+
+enum class GameStatus : uint8_t {
+    PLAYING,
+    PAUSED,
+    GAME_OVER
+};
+
+// Everything the rules need to advance a game. Contains no SDL types, so it
+// can be stepped headless at any rate. Plain fixed-size data with no
+// pointers: a snapshot is a copy, and copies are a single memcpy.
+struct GameState {
+    Board board;
+    PieceGenerator generator;   // upcoming pieces, see rules::preview
+    Piece current;
+    GameStatus status;
+
+    int score;
+    int level;
+    int linesCleared;
+    int pieces;         // pieces spawned since the game started
+
+    int fallTimer;      // ticks since the last gravity step
+    int fallInterval;   // ticks between gravity steps at the current level
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value,
+              "GameState is saved and restored with memcpy");
+
+// The fields of one game held by reference, so the rules also run on games
+// stored field by field in separate arrays (see MultiGame)
+struct GameRef {
+    Board& board;
+    PieceGenerator& generator;
+    Piece& current;
+    GameStatus& status;
+    int& score;
+    int& level;
+    int& linesCleared;
+    int& pieces;
+    int& fallTimer;
+    int& fallInterval;
+};
+
+// What happened during a call into the rules
+struct StepResult {
+    int piecesLocked = 0;
+    int linesCleared = 0;
+};
+
+namespace rules {
+
+constexpr int TICKS_PER_SECOND = 60;
+constexpr int INITIAL_FALL_INTERVAL = TICKS_PER_SECOND;
+constexpr int FALL_INTERVAL_STEP = TICKS_PER_SECOND / 10;
+constexpr int MIN_FALL_INTERVAL = TICKS_PER_SECOND / 10;
+// From this level on gravity is instant (20G): the piece sits on the stack
+// as soon as it spawns or moves, and the fall interval turns into a lock
+// delay that restarts whenever the piece shifts or rotates
+constexpr int INSTANT_GRAVITY_LEVEL = 20;
+
+// Fixed-size image of a GameState. It is the raw bytes in native layout,
+// so a blob only loads back into a build of the same code.
+using StateBlob = std::array<uint8_t, sizeof(GameState)>;
+
+void save(const GameState& state, StateBlob& blob);
+void load(const StateBlob& blob, GameState& state);
+
+// Hash of everything that decides how the game continues. States reached
+// along different paths hash alike when they are the same position.
+uint64_t hash(const GameState& state);
+
+// Start a new game whose piece sequence is fully determined by seed
+void reset(GameState& state, uint32_t seed, Randomizer randomizer = Randomizer::BAG);
+void reset(GameRef state, uint32_t seed, Randomizer randomizer = Randomizer::BAG);
+
+// Upcoming piece at its spawn position, 0 = the one after current.
+// index must be below PieceGenerator::MAX_PREVIEW.
+inline Piece preview(const GameState& state, int index = 0) {
+    return Piece(state.generator.peek(index));
+}
+
+// Apply one player action. PAUSE toggles pause, or restarts after game over.
+StepResult applyAction(GameState& state, InputAction action);
+StepResult applyAction(GameRef state, InputAction action);
+
+// Advance the game clock by one tick, applying gravity when it is due
+StepResult tick(GameState& state);
+StepResult tick(GameRef state);
+
+// applyAction followed by tick
+StepResult step(GameState& state, InputAction action);
+
+// Raise lines garbage rows with a gap in column hole under the stack. The
+// current piece is lifted out of the way when it can be; the game is over
+// when blocks go off the top or the piece is left stuck in the stack.
+void addGarbage(GameState& state, int lines, int hole);
+
+bool canPlace(const Board& board, const Piece& piece);
+
+// Movement shared by player input and the placement search. Each returns
+// false and leaves the piece untouched when the move is blocked.
+bool tryMove(const Board& board, Piece& piece, int dx, int dy);
+// floorKick adds a kick one row up after the sideways ones. Under 20G the
+// piece always rests on the stack, so without it most pieces could never
+// turn out of their spawn orientation.
+bool tryRotate(const Board& board, Piece& piece, int direction, bool floorKick = false);
+
+// Number of rows the piece can fall before it comes to rest
+int dropDistance(const Board& board, const Piece& piece);
+
+} // namespace rules
@@ -0,0 +1,59 @@
+#include "Simulator.hpp"
+#include "AllocationCounter.hpp"
+#include "Policy.hpp"
+#include "Replay.hpp"
+#include "Rules.hpp"
+#include "ThreadPool.hpp"
+
+GameResult playGame(const SimConfig& config, uint32_t seed) {
+    GameResult result{seed, 0, 0, 0, 0, 0};
+    auto policy = createPolicy(config.policy, seed, config.bot);
+    if (!policy) return result;
+
+    GameState state;
+    rules::reset(state, seed, config.randomizer);
+
+    bool recording = !config.recordDir.empty();
+    ReplayRecorder recorder;
+    if (recording) recorder.begin(seed, config.randomizer);
+
+    while (state.status == GameStatus::PLAYING) {
+#ifdef TETRIS_COUNT_ALLOCS
+        uint64_t allocationsBefore = allocs::count();
+#endif
+        InputAction action = policy->nextAction(state);
+        StepResult stepped = rules::step(state, action);
+#ifdef TETRIS_COUNT_ALLOCS
+        if (result.ticks >= ALLOC_WARMUP_TICKS) {
+            result.allocations += allocs::count() - allocationsBefore;
+        }
+#endif
+        result.pieces += stepped.piecesLocked;
+        ++result.ticks;
+        if (recording) {
+            recorder.action(action);
+            recorder.tick();
+        }
+
+        if (config.maxPieces > 0 && result.pieces >= config.maxPieces) break;
+    }
+
+    if (recording) {
+        saveReplay(config.recordDir + "/" + std::to_string(seed) + ".replay", recorder.finish(state));
+    }
+
+    result.score = state.score;
+    result.lines = state.linesCleared;
+    return result;
+}
+
+std::vector<GameResult> runGames(const SimConfig& config, ThreadPool& pool) {
+    std::vector<GameResult> results(config.games);
+    for (int i = 0; i < config.games; ++i) {
+        pool.submit([&config, &results, i] {
+            results[i] = playGame(config, config.seed + static_cast<uint32_t>(i));
+        });
+    }
+    pool.wait();
+    return results;
+}
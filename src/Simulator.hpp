@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Bot.hpp"
+#include "PieceGenerator.hpp"
+
+class ThreadPool;
+
+struct SimConfig {
+    int games = 100;
+    uint32_t seed = 1;        // game i is played with seed + i
+    int maxPieces = 0;        // 0 = play until the stack tops out
+    std::string policy = "drop";
+    Randomizer randomizer = Randomizer::BAG;
+    BotConfig bot;            // used by the "bot" policy
+    std::string recordDir;    // when set, each game is saved as <dir>/<seed>.replay
+};
+
+struct GameResult {
+    uint32_t seed;
+    int score;
+    int lines;
+    int pieces;
+    uint64_t ticks;
+    // Heap allocations by the policy and rules after the first
+    // ALLOC_WARMUP_TICKS ticks; only counted in TETRIS_COUNT_ALLOCS builds
+    uint64_t allocations;
+};
+
+// Ticks a game runs before its allocations count, so buffers that grow to
+// their working size on the first few pieces are not reported
+constexpr uint64_t ALLOC_WARMUP_TICKS = 1000;
+
+// Play one headless game to completion with a fresh policy instance
+GameResult playGame(const SimConfig& config, uint32_t seed);
+
+// Play config.games games spread across the pool, results in seed order
+std::vector<GameResult> runGames(const SimConfig& config, ThreadPool& pool);
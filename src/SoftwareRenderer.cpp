@@ -0,0 +1,287 @@
+#include "SoftwareRenderer.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iterator>
+
+namespace {
+
+// 5x7 glyphs for ' ' through 'Z', one byte per row with the leftmost pixel
+// in bit 4. Lowercase letters are drawn with the uppercase glyphs.
+constexpr char FIRST_GLYPH = ' ';
+constexpr char LAST_GLYPH = 'Z';
+constexpr int GLYPH_WIDTH = 5;
+constexpr int GLYPH_HEIGHT = 7;
+constexpr int GLYPH_SCALE = 2;
+constexpr int GLYPH_ADVANCE = (GLYPH_WIDTH + 1) * GLYPH_SCALE;
+
+constexpr std::array<std::array<uint8_t, GLYPH_HEIGHT>, LAST_GLYPH - FIRST_GLYPH + 1> FONT = {{
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // ' '
+    {{0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04}}, // '!'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '"'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '#'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '$'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '%'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '&'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '\''
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '('
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // ')'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '*'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '+'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // ','
+    {{0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00}}, // '-'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c}}, // '.'
+    {{0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}}, // '/'
+    {{0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e}}, // '0'
+    {{0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e}}, // '1'
+    {{0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f}}, // '2'
+    {{0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e}}, // '3'
+    {{0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02}}, // '4'
+    {{0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e}}, // '5'
+    {{0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e}}, // '6'
+    {{0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}}, // '7'
+    {{0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e}}, // '8'
+    {{0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c}}, // '9'
+    {{0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00}}, // ':'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // ';'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '<'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '='
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '>'
+    {{0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}}, // '?'
+    {{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, // '@'
+    {{0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11}}, // 'A'
+    {{0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e}}, // 'B'
+    {{0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e}}, // 'C'
+    {{0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c}}, // 'D'
+    {{0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f}}, // 'E'
+    {{0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10}}, // 'F'
+    {{0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f}}, // 'G'
+    {{0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11}}, // 'H'
+    {{0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e}}, // 'I'
+    {{0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c}}, // 'J'
+    {{0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}}, // 'K'
+    {{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f}}, // 'L'
+    {{0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11}}, // 'M'
+    {{0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}}, // 'N'
+    {{0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}}, // 'O'
+    {{0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10}}, // 'P'
+    {{0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d}}, // 'Q'
+    {{0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11}}, // 'R'
+    {{0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e}}, // 'S'
+    {{0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}}, // 'T'
+    {{0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e}}, // 'U'
+    {{0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04}}, // 'V'
+    {{0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a}}, // 'W'
+    {{0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11}}, // 'X'
+    {{0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04}}, // 'Y'
+    {{0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f}}, // 'Z'
+}};
+
+constexpr uint32_t WHITE = Framebuffer::pack(255, 255, 255);
+
+uint32_t toPixel(layout::Color color, uint8_t alpha = 255) {
+    return Framebuffer::pack(color.r, color.g, color.b, alpha);
+}
+
+} // namespace
+
+SoftwareRenderer::SoftwareRenderer()
+    : frame_(layout::WINDOW_WIDTH, layout::WINDOW_HEIGHT)
+    , background_(layout::WINDOW_WIDTH, layout::WINDOW_HEIGHT)
+    , boardLayer_(BOARD_LAYER_WIDTH, BOARD_LAYER_HEIGHT)
+    , layerGeneration_(0) {
+    drawBackground();
+}
+
+void SoftwareRenderer::drawGame(const GameState& state) {
+    frame_.blit(background_, 0, 0);
+    updateBoardLayer(state.board);
+    frame_.blit(boardLayer_, layout::GRID_OFFSET_X, layout::GRID_OFFSET_Y);
+
+    if (state.status == GameStatus::PLAYING) {
+        Piece ghost = state.current;
+        ghost.move(0, rules::dropDistance(state.board, ghost));
+        drawPiece(ghost, true);
+    }
+    drawPiece(state.current, false);
+    drawNextPiece(rules::preview(state));
+    drawUI(state.score, state.level, state.linesCleared);
+
+    if (state.status == GameStatus::GAME_OVER) {
+        drawOverlay(layout::GAME_OVER_LABELS, static_cast<int>(std::size(layout::GAME_OVER_LABELS)));
+    } else if (state.status == GameStatus::PAUSED) {
+        drawOverlay(layout::PAUSED_LABELS, static_cast<int>(std::size(layout::PAUSED_LABELS)));
+    }
+}
+
+void SoftwareRenderer::drawDemo() {
+    drawText(frame_, "DEMO - press B to play", layout::GRID_OFFSET_X + 40, layout::GRID_OFFSET_Y - 30);
+}
+
+void SoftwareRenderer::drawWall(const MultiGame& games) {
+    const layout::WallLayout wall = layout::wallLayout(games.size(), frame_.width(), frame_.height());
+    const int cell = wall.cellSize;
+    // Cells keep a 1px gap once they are big enough to show it
+    const int fill = cell >= 4 ? cell - 1 : cell;
+
+    frame_.fill(toPixel(layout::BACKGROUND));
+    for (int i = 0; i < games.size(); ++i) {
+        int originX = wall.boardX(i);
+        int originY = wall.boardY(i);
+        frame_.fillRect(originX, originY, Board::WIDTH * cell, Board::HEIGHT * cell, toPixel(layout::WALL_BOARD));
+
+        const Board& board = games.board(i);
+        for (int y = 0; y < Board::HEIGHT; ++y) {
+            const std::array<uint8_t, Board::WIDTH>& colors = board.getRowColors(y + Board::HIDDEN_ROWS);
+            for (uint32_t bits = board.getRow(y + Board::HIDDEN_ROWS); bits != 0; bits &= bits - 1) {
+                int x = __builtin_ctz(bits);
+                frame_.fillRect(originX + x * cell, originY + y * cell, fill, fill,
+                                toPixel(layout::CELL_COLORS[colors[x]]));
+            }
+        }
+
+        const Piece& piece = games.current(i);
+        uint32_t pieceColor = toPixel(layout::CELL_COLORS[piece.getColor()]);
+        for (const auto& [x, y] : piece.getBlocks()) {
+            if (y < Board::HIDDEN_ROWS) continue;
+            frame_.fillRect(originX + x * cell, originY + (y - Board::HIDDEN_ROWS) * cell, fill, fill, pieceColor);
+        }
+
+        if (games.status(i) == GameStatus::GAME_OVER) {
+            frame_.blendRect(originX, originY, Board::WIDTH * cell, Board::HEIGHT * cell,
+                             Framebuffer::pack(0, 0, 0, layout::OVERLAY_ALPHA));
+        }
+        if (wall.labels) {
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%d", games.score(i));
+            drawText(frame_, buffer, originX, originY + Board::HEIGHT * cell + 4);
+        }
+    }
+}
+
+void SoftwareRenderer::drawBackground() {
+    background_.fill(toPixel(layout::BACKGROUND));
+    background_.fillRect(layout::GRID_OFFSET_X - 2, layout::GRID_OFFSET_Y - 2,
+                         Board::WIDTH * layout::CELL_SIZE + 4, Board::HEIGHT * layout::CELL_SIZE + 4,
+                         toPixel(layout::BORDER));
+    background_.fillRect(layout::PREVIEW_OFFSET_X - 5, layout::PREVIEW_OFFSET_Y - 30, 120, 130,
+                         toPixel(layout::PREVIEW_BOX));
+    for (const layout::Label& label : layout::STATIC_LABELS) {
+        drawText(background_, label.text, label.x, label.y);
+    }
+}
+
+void SoftwareRenderer::updateBoardLayer(BoardView board) {
+    if (board.generation() == layerGeneration_) return;
+
+    // Cells leave a gap around themselves that shows the background, as in
+    // the SDL renderer
+    boardLayer_.fill(toPixel(layout::BACKGROUND));
+    for (int y = 0; y < Board::HEIGHT; ++y) {
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            drawCell(boardLayer_, x, y, board.getCell(x, y + Board::HIDDEN_ROWS), 0, 0, false);
+        }
+    }
+
+    uint32_t line = toPixel(layout::GRID_LINE);
+    for (int x = 0; x <= Board::WIDTH; ++x) {
+        boardLayer_.fillRect(x * layout::CELL_SIZE, 0, 1, BOARD_LAYER_HEIGHT, line);
+    }
+    for (int y = 0; y <= Board::HEIGHT; ++y) {
+        boardLayer_.fillRect(0, y * layout::CELL_SIZE, BOARD_LAYER_WIDTH, 1, line);
+    }
+    layerGeneration_ = board.generation();
+}
+
+void SoftwareRenderer::drawPiece(const Piece& piece, bool ghost) {
+    // No piece before the first spawn; NONE has no mask to read
+    if (piece.getType() == PieceType::NONE) return;
+    const PieceMask& mask = piece.getMask();
+    for (int by = mask.minY; by <= mask.maxY; ++by) {
+        int y = piece.getY() + by;
+        // Skip hidden rows
+        if (y < Board::HIDDEN_ROWS) continue;
+        for (int bx = mask.minX; bx <= mask.maxX; ++bx) {
+            if (!(mask.rows[by] >> bx & 1u)) continue;
+            drawCell(frame_, piece.getX() + bx, y - Board::HIDDEN_ROWS, piece.getColor(),
+                     layout::GRID_OFFSET_X, layout::GRID_OFFSET_Y, ghost);
+        }
+    }
+}
+
+void SoftwareRenderer::drawNextPiece(const Piece& piece) {
+    if (piece.getType() == PieceType::NONE) return;
+    // Center the piece in the preview box
+    const PieceMask& mask = piece.getMask();
+    int offsetX = (4 - (mask.maxX - mask.minX + 1)) / 2;
+    int offsetY = (4 - (mask.maxY - mask.minY + 1)) / 2;
+    for (int by = mask.minY; by <= mask.maxY; ++by) {
+        for (int bx = mask.minX; bx <= mask.maxX; ++bx) {
+            if (!(mask.rows[by] >> bx & 1u)) continue;
+            drawCell(frame_, bx - mask.minX + offsetX, by - mask.minY + offsetY, piece.getColor(),
+                     layout::PREVIEW_OFFSET_X, layout::PREVIEW_OFFSET_Y, false);
+        }
+    }
+}
+
+void SoftwareRenderer::drawUI(int score, int level, int lines) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "SCORE: %d", score);
+    drawText(frame_, buffer, layout::PREVIEW_OFFSET_X, layout::SCORE_Y);
+    snprintf(buffer, sizeof(buffer), "LEVEL: %d", level);
+    drawText(frame_, buffer, layout::PREVIEW_OFFSET_X, layout::LEVEL_Y);
+    snprintf(buffer, sizeof(buffer), "LINES: %d", lines);
+    drawText(frame_, buffer, layout::PREVIEW_OFFSET_X, layout::LINES_Y);
+}
+
+void SoftwareRenderer::drawOverlay(const layout::Label* labels, int count) {
+    frame_.blendRect(0, 0, layout::WINDOW_WIDTH, layout::WINDOW_HEIGHT,
+                     Framebuffer::pack(0, 0, 0, layout::OVERLAY_ALPHA));
+    for (int i = 0; i < count; ++i) {
+        drawText(frame_, labels[i].text, labels[i].x, labels[i].y);
+    }
+}
+
+void SoftwareRenderer::drawCell(Framebuffer& target, int x, int y, int color, int offsetX, int offsetY,
+                                bool ghost) {
+    int drawX = offsetX + x * layout::CELL_SIZE + 1;
+    int drawY = offsetY + y * layout::CELL_SIZE + 1;
+    int size = layout::CELL_SIZE - 2;
+    layout::Color c = layout::CELL_COLORS[color];
+
+    if (ghost) {
+        target.blendRect(drawX, drawY, size, size, toPixel(c, layout::GHOST_FILL_ALPHA));
+        uint32_t outline = toPixel(c, layout::GHOST_OUTLINE_ALPHA);
+        target.blendRect(drawX, drawY, size, 1, outline);
+        target.blendRect(drawX, drawY + size - 1, size, 1, outline);
+        target.blendRect(drawX, drawY + 1, 1, size - 2, outline);
+        target.blendRect(drawX + size - 1, drawY + 1, 1, size - 2, outline);
+        return;
+    }
+
+    // Highlight, body and shadow bands, as in Renderer::drawCell
+    layout::Color highlight = {uint8_t(std::min(255, c.r + 40)), uint8_t(std::min(255, c.g + 40)),
+                               uint8_t(std::min(255, c.b + 40))};
+    layout::Color shadow = {uint8_t(c.r * 0.7), uint8_t(c.g * 0.7), uint8_t(c.b * 0.7)};
+    target.fillRect(drawX, drawY, size, 3, toPixel(highlight));
+    target.fillRect(drawX, drawY + 3, size, size - 6, toPixel(c));
+    target.fillRect(drawX, drawY + size - 3, size, 3, toPixel(shadow));
+}
+
+void SoftwareRenderer::drawText(Framebuffer& target, const char* text, int x, int y) {
+    int penX = x;
+    for (const char* ch = text; *ch; ++ch, penX += GLYPH_ADVANCE) {
+        char c = (*ch >= 'a' && *ch <= 'z') ? static_cast<char>(*ch - 'a' + 'A') : *ch;
+        if (c < FIRST_GLYPH || c > LAST_GLYPH) continue;
+
+        const std::array<uint8_t, GLYPH_HEIGHT>& glyph = FONT[c - FIRST_GLYPH];
+        for (int gy = 0; gy < GLYPH_HEIGHT; ++gy) {
+            for (int gx = 0; gx < GLYPH_WIDTH; ++gx) {
+                if (glyph[gy] >> (GLYPH_WIDTH - 1 - gx) & 1u) {
+                    target.fillRect(penX + gx * GLYPH_SCALE, y + gy * GLYPH_SCALE,
+                                    GLYPH_SCALE, GLYPH_SCALE, WHITE);
+                }
+            }
+        }
+    }
+}
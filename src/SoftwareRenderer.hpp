@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include "Board.hpp"
+#include "Framebuffer.hpp"
+#include "Layout.hpp"
+#include "MultiGame.hpp"
+#include "Rules.hpp"
+
+// Draws the same frame as Renderer into a Framebuffer on the CPU, with a
+// built-in bitmap font, so frames can be produced without SDL, a display
+// or a GPU. Like Renderer it caches the static background and the locked
+// board, and only redraws the board when its generation changes.
+class SoftwareRenderer {
+public:
+    SoftwareRenderer();
+
+    void drawGame(const GameState& state);
+    void drawDemo();
+    // Every board of a multi-board game, scaled to fit the frame
+    void drawWall(const MultiGame& games);
+
+    const Framebuffer& frame() const { return frame_; }
+
+private:
+    void drawBackground();
+    void updateBoardLayer(BoardView board);
+    void drawPiece(const Piece& piece, bool ghost);
+    void drawNextPiece(const Piece& piece);
+    void drawUI(int score, int level, int lines);
+    void drawOverlay(const layout::Label* labels, int count);
+
+    static void drawCell(Framebuffer& target, int x, int y, int color, int offsetX, int offsetY, bool ghost);
+    static void drawText(Framebuffer& target, const char* text, int x, int y);
+
+    static constexpr int BOARD_LAYER_WIDTH = Board::WIDTH * layout::CELL_SIZE + 1;
+    static constexpr int BOARD_LAYER_HEIGHT = Board::HEIGHT * layout::CELL_SIZE + 1;
+
+    Framebuffer frame_;
+    Framebuffer background_;
+    Framebuffer boardLayer_;
+    uint64_t layerGeneration_;
+};
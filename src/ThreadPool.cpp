@@ -0,0 +1,109 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace {
+
+// Index of the pool worker running on this thread, or -1 elsewhere
+thread_local int currentWorker = -1;
+thread_local const ThreadPool* currentPool = nullptr;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threads)
+    : queued_(0)
+    , pending_(0)
+    , nextQueue_(0)
+    , stopping_(false) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    unsigned index = (currentPool == this)
+        ? static_cast<unsigned>(currentWorker)
+        : nextQueue_.fetch_add(1, std::memory_order_relaxed) % size();
+
+    pending_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_.fetch_add(1);
+    }
+    workAvailable_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    allDone_.wait(lock, [this] { return pending_.load() == 0; });
+}
+
+bool ThreadPool::popTask(unsigned index, std::function<void()>& task) {
+    {
+        Queue& own = *queues_[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (unsigned offset = 1; offset < size(); ++offset) {
+        Queue& victim = *queues_[(index + offset) % size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    currentWorker = static_cast<int>(index);
+    currentPool = this;
+
+    std::function<void()> task;
+    while (true) {
+        if (popTask(index, task)) {
+            queued_.fetch_sub(1);
+            task();
+            task = nullptr;
+
+            if (pending_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                allDone_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        workAvailable_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool with one task deque per worker. Workers pop their own
+// queue LIFO and steal FIFO from the others when it runs dry, so uneven
+// task lengths (games that top out early vs. long ones) balance themselves.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = 0); // 0 = one per hardware thread
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Tasks submitted from a worker go to that worker's own queue
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popTask(unsigned index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable allDone_;
+    std::atomic<size_t> queued_;
+    std::atomic<size_t> pending_;
+    std::atomic<unsigned> nextQueue_;
+    bool stopping_;
+};
@@ -0,0 +1,97 @@
+#include "Trace.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace trace {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Event {
+    const char* name;
+    uint64_t begin;
+    uint64_t end;
+};
+
+static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0, "ring capacity must be a power of two");
+
+struct Ring {
+    explicit Ring(int id) : tid(id), written(0) {}
+
+    int tid;
+    // Total events ever recorded, the slot is written % RING_CAPACITY
+    std::atomic<uint64_t> written;
+    std::array<Event, RING_CAPACITY> events;
+};
+
+// Rings are never freed, so events from threads that have exited are still
+// written out
+std::mutex registryMutex;
+std::vector<std::unique_ptr<Ring>> registry;
+
+Ring* threadRing() {
+    thread_local Ring* ring = nullptr;
+    if (!ring) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        registry.push_back(std::make_unique<Ring>(static_cast<int>(registry.size()) + 1));
+        ring = registry.back().get();
+    }
+    return ring;
+}
+
+// Trace names are literals from our own code, but keep the JSON valid anyway
+void writeName(std::FILE* file, const char* name) {
+    for (const char* c = name; *c; ++c) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', file);
+        std::fputc(*c, file);
+    }
+}
+
+} // namespace
+
+uint64_t now() {
+    static const Clock::time_point epoch = Clock::now();
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+void record(const char* name, uint64_t begin, uint64_t end) {
+    Ring* ring = threadRing();
+    uint64_t index = ring->written.load(std::memory_order_relaxed);
+    ring->events[index & (RING_CAPACITY - 1)] = {name, begin, end};
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+bool writeJson(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) return false;
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", file);
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& ring : registry) {
+        uint64_t written = ring->written.load(std::memory_order_acquire);
+        uint64_t oldest = written > RING_CAPACITY ? written - RING_CAPACITY : 0;
+        for (uint64_t i = oldest; i < written; ++i) {
+            const Event& event = ring->events[i & (RING_CAPACITY - 1)];
+            std::fputs(first ? "\n{\"name\":\"" : ",\n{\"name\":\"", file);
+            writeName(file, event.name);
+            // Complete events, timestamps in microseconds
+            std::fprintf(file, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         ring->tid, event.begin / 1000.0, (event.end - event.begin) / 1000.0);
+            first = false;
+        }
+    }
+
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
+
+} // namespace trace
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Scoped timeline markers for the hot paths, written out as Chrome trace
+// event JSON (chrome://tracing, ui.perfetto.dev). Build with -DTETRIS_TRACE=ON
+// to compile them in; otherwise TRACE_SCOPE expands to nothing and the
+// markers cost nothing.
+//
+// Each thread records into its own fixed ring of the most recent events, so
+// recording takes no lock and never allocates after the first event on a
+// thread. Only the latest RING_CAPACITY events per thread are kept.
+namespace trace {
+
+#ifdef TETRIS_TRACE
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+// Events kept per thread, a few seconds of frames with every marker active
+constexpr int RING_CAPACITY = 1 << 16;
+
+// Nanoseconds since the first call in this process
+uint64_t now();
+
+// Record one complete event. name must outlive the trace (a string literal).
+void record(const char* name, uint64_t begin, uint64_t end);
+
+// Write every thread's buffered events as trace JSON. Call it from a thread
+// that is recording, or while the others are idle, since a ring that is
+// being written can wrap under the reader. Returns false if path cannot be
+// written.
+bool writeJson(const std::string& path);
+
+class Scope {
+public:
+    explicit Scope(const char* name) : name_(name), begin_(now()) {}
+    ~Scope() { record(name_, begin_, now()); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t begin_;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef TETRIS_TRACE
+#define TRACE_SCOPE(name) trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#endif
@@ -0,0 +1,300 @@
+#include "Tuner.hpp"
+#include "Simulator.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+namespace {
+
+constexpr int N = WeightTuner::DIMENSIONS;
+
+double norm(const WeightTuner::Vector& v) {
+    double sum = 0.0;
+    for (double x : v) sum += x * x;
+    return std::sqrt(sum);
+}
+
+void normalize(WeightTuner::Vector& v) {
+    double length = norm(v);
+    if (length > 0.0) {
+        for (double& x : v) x /= length;
+    }
+}
+
+// Cyclic Jacobi rotations; at five dimensions a few sweeps reach double
+// precision. Eigenvectors end up as the columns of vectors.
+template <typename Matrix, typename Vector>
+void symmetricEigen(Matrix a, Matrix& vectors, Vector& values) {
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) vectors[i][j] = i == j ? 1.0 : 0.0;
+    }
+
+    for (int sweep = 0; sweep < 50; ++sweep) {
+        double offDiagonal = 0.0;
+        for (int p = 0; p < N; ++p) {
+            for (int q = p + 1; q < N; ++q) offDiagonal += a[p][q] * a[p][q];
+        }
+        if (offDiagonal < 1e-30) break;
+
+        for (int p = 0; p < N; ++p) {
+            for (int q = p + 1; q < N; ++q) {
+                if (std::abs(a[p][q]) < 1e-300) continue;
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+                for (int k = 0; k < N; ++k) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < N; ++k) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < N; ++k) {
+                    double vkp = vectors[k][p], vkq = vectors[k][q];
+                    vectors[k][p] = c * vkp - s * vkq;
+                    vectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < N; ++i) values[i] = a[i][i];
+}
+
+// Running totals of one candidate, shared by the tasks playing its games
+struct CandidateScore {
+    std::atomic<int> games{0};
+    // Games finished out of the first minGames, the prefix pruning looks at
+    std::atomic<int> prefixGames{0};
+    std::atomic<bool> pruned{false};
+};
+
+double meanLines(const int* lines, int games) {
+    int64_t total = 0;
+    for (int g = 0; g < games; ++g) total += lines[g];
+    return static_cast<double>(total) / games;
+}
+
+} // namespace
+
+WeightTuner::WeightTuner(const TuneConfig& config)
+    : config_(config)
+    , rng_(config.seed)
+    , generation_(0)
+    , previousCutoff_(0.0)
+    , sigma_(config.sigma) {
+    // Default strategy parameters (Hansen, "The CMA Evolution Strategy: A Tutorial")
+    lambda_ = config.population > 0 ? std::max(config.population, 2)
+                                    : 4 + static_cast<int>(3.0 * std::log(double(N)));
+    mu_ = lambda_ / 2;
+    recombination_.resize(mu_);
+    for (int i = 0; i < mu_; ++i) {
+        recombination_[i] = std::log(mu_ + 0.5) - std::log(i + 1.0);
+    }
+    double sum = std::accumulate(recombination_.begin(), recombination_.end(), 0.0);
+    double sumSquares = 0.0;
+    for (double& w : recombination_) {
+        w /= sum;
+        sumSquares += w * w;
+    }
+    muEff_ = 1.0 / sumSquares;
+
+    cSigma_ = (muEff_ + 2.0) / (N + muEff_ + 5.0);
+    dSigma_ = 1.0 + 2.0 * std::max(0.0, std::sqrt((muEff_ - 1.0) / (N + 1.0)) - 1.0) + cSigma_;
+    cC_ = (4.0 + muEff_ / N) / (N + 4.0 + 2.0 * muEff_ / N);
+    c1_ = 2.0 / ((N + 1.3) * (N + 1.3) + muEff_);
+    cMu_ = std::min(1.0 - c1_, 2.0 * (muEff_ - 2.0 + 1.0 / muEff_) / ((N + 2.0) * (N + 2.0) + muEff_));
+    chiN_ = std::sqrt(double(N)) * (1.0 - 1.0 / (4.0 * N) + 1.0 / (21.0 * N * N));
+
+    mean_ = fromWeights(config.bot.weights);
+    normalize(mean_);
+    pathSigma_.fill(0.0);
+    pathC_.fill(0.0);
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) covariance_[i][j] = i == j ? 1.0 : 0.0;
+    }
+    decompose();
+}
+
+WeightTuner::Vector WeightTuner::fromWeights(const BotWeights& weights) {
+    return {weights.height, weights.holes, weights.bumpiness, weights.wells, weights.lines};
+}
+
+BotWeights WeightTuner::toWeights(const Vector& vector) {
+    BotWeights weights;
+    weights.height = vector[0];
+    weights.holes = vector[1];
+    weights.bumpiness = vector[2];
+    weights.wells = vector[3];
+    weights.lines = vector[4];
+    return weights;
+}
+
+TuneGeneration WeightTuner::step(ThreadPool& pool) {
+    TuneGeneration report;
+    report.generation = ++generation_;
+
+    // x = mean + sigma * B * D * z
+    std::normal_distribution<double> gaussian;
+    std::vector<Vector> candidates(lambda_);
+    for (Vector& x : candidates) {
+        Vector z;
+        for (double& value : z) value = gaussian(rng_);
+        for (int i = 0; i < N; ++i) {
+            double y = 0.0;
+            for (int j = 0; j < N; ++j) y += basis_[i][j] * scales_[j] * z[j];
+            x[i] = mean_[i] + sigma_ * y;
+        }
+    }
+
+    std::vector<double> fitness = evaluate(candidates, pool, report);
+    int best = static_cast<int>(std::max_element(fitness.begin(), fitness.end()) - fitness.begin());
+    Vector bestVector = candidates[best];
+    normalize(bestVector);
+    report.bestFitness = fitness[best];
+    report.best = toWeights(bestVector);
+
+    update(candidates, fitness);
+    report.cutoff = previousCutoff_;
+    report.sigma = sigma_;
+    report.mean = mean();
+    return report;
+}
+
+std::vector<double> WeightTuner::evaluate(const std::vector<Vector>& candidates, ThreadPool& pool,
+                                          TuneGeneration& report) {
+    const int count = static_cast<int>(candidates.size());
+    const int games = std::max(1, config_.games);
+    const int minGames = std::max(1, games / 4);
+    const double threshold = previousCutoff_ * config_.pruneFraction;
+    // Every candidate of a generation plays the same seeds, so luck of the
+    // draw does not decide the ranking
+    const uint32_t firstSeed = config_.seed + static_cast<uint32_t>(generation_) * static_cast<uint32_t>(games);
+
+    std::vector<SimConfig> configs(count);
+    std::unique_ptr<CandidateScore[]> scores(new CandidateScore[count]);
+    for (int c = 0; c < count; ++c) {
+        Vector unit = candidates[c];
+        normalize(unit);
+        configs[c].policy = "bot";
+        configs[c].maxPieces = config_.maxPieces;
+        configs[c].bot = config_.bot;
+        configs[c].bot.weights = toWeights(unit);
+    }
+
+    // Lines of each game, candidate-major. A candidate is pruned on the mean
+    // of its first minGames games, whatever order the games finish in, so a
+    // seed always gives the same run.
+    std::vector<int> lines(static_cast<size_t>(count) * games, 0);
+
+    // Workers take their newest task first, so the games are submitted last
+    // to first and the prefix of every candidate is played early, while the
+    // games pruning can skip are still waiting
+    for (int g = games - 1; g >= 0; --g) {
+        for (int c = 0; c < count; ++c) {
+            CandidateScore* score = &scores[c];
+            const SimConfig* simConfig = &configs[c];
+            int* row = &lines[static_cast<size_t>(c) * games];
+            uint32_t seed = firstSeed + static_cast<uint32_t>(g);
+            pool.submit([score, simConfig, row, g, seed, minGames, threshold] {
+                if (score->pruned.load(std::memory_order_relaxed)) return;
+                row[g] = playGame(*simConfig, seed).lines;
+                score->games.fetch_add(1, std::memory_order_relaxed);
+                // The task finishing the prefix sees every prefix game
+                if (g < minGames && score->prefixGames.fetch_add(1, std::memory_order_acq_rel) + 1 == minGames &&
+                    meanLines(row, minGames) < threshold) {
+                    score->pruned.store(true, std::memory_order_relaxed);
+                }
+            });
+        }
+    }
+    pool.wait();
+
+    std::vector<double> fitness(count);
+    for (int c = 0; c < count; ++c) {
+        const int* row = &lines[static_cast<size_t>(c) * games];
+        bool pruned = scores[c].pruned.load();
+        fitness[c] = meanLines(row, pruned ? minGames : games);
+        report.gamesPlayed += scores[c].games.load();
+        if (pruned) ++report.candidatesPruned;
+    }
+    return fitness;
+}
+
+void WeightTuner::update(const std::vector<Vector>& candidates, const std::vector<double>& fitness) {
+    std::vector<int> order(candidates.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&fitness](int a, int b) { return fitness[a] > fitness[b]; });
+    previousCutoff_ = fitness[order[mu_ - 1]];
+
+    // Steps of the selected candidates from the old mean, in units of sigma.
+    // Lengthening the weights changes nothing, but it favours candidates
+    // that point closer to the mean, so the part of each step along the
+    // mean is removed; left in, it keeps the paths long and sigma grows
+    // without bound.
+    std::vector<Vector> steps(mu_);
+    Vector meanStep{};
+    for (int i = 0; i < mu_; ++i) {
+        double radial = 0.0;
+        for (int d = 0; d < N; ++d) {
+            steps[i][d] = (candidates[order[i]][d] - mean_[d]) / sigma_;
+            radial += steps[i][d] * mean_[d];
+        }
+        for (int d = 0; d < N; ++d) {
+            steps[i][d] -= radial * mean_[d];
+            meanStep[d] += recombination_[i] * steps[i][d];
+        }
+    }
+    for (int d = 0; d < N; ++d) mean_[d] += sigma_ * meanStep[d];
+
+    // C^-1/2 * meanStep = B * D^-1 * B^T * meanStep
+    Vector whitened{};
+    for (int j = 0; j < N; ++j) {
+        double projected = 0.0;
+        for (int i = 0; i < N; ++i) projected += basis_[i][j] * meanStep[i];
+        projected /= scales_[j];
+        for (int i = 0; i < N; ++i) whitened[i] += basis_[i][j] * projected;
+    }
+
+    double sigmaRate = std::sqrt(cSigma_ * (2.0 - cSigma_) * muEff_);
+    for (int d = 0; d < N; ++d) {
+        pathSigma_[d] = (1.0 - cSigma_) * pathSigma_[d] + sigmaRate * whitened[d];
+    }
+    double pathLength = norm(pathSigma_);
+    double decay = 1.0 - std::pow(1.0 - cSigma_, 2.0 * generation_);
+    bool stalled = pathLength / std::sqrt(decay) / chiN_ >= 1.4 + 2.0 / (N + 1.0);
+
+    double cRate = std::sqrt(cC_ * (2.0 - cC_) * muEff_);
+    for (int d = 0; d < N; ++d) {
+        pathC_[d] = (1.0 - cC_) * pathC_[d] + (stalled ? 0.0 : cRate * meanStep[d]);
+    }
+
+    double rankOneCorrection = stalled ? c1_ * cC_ * (2.0 - cC_) : 0.0;
+    for (int i = 0; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+            double rankMu = 0.0;
+            for (int k = 0; k < mu_; ++k) rankMu += recombination_[k] * steps[k][i] * steps[k][j];
+            covariance_[i][j] = (1.0 - c1_ - cMu_) * covariance_[i][j] + c1_ * pathC_[i] * pathC_[j] +
+                                rankOneCorrection * covariance_[i][j] + cMu_ * rankMu;
+        }
+    }
+    sigma_ *= std::exp((cSigma_ / dSigma_) * (pathLength / chiN_ - 1.0));
+
+    // Back onto the unit sphere, so sigma keeps its meaning
+    normalize(mean_);
+    decompose();
+}
+
+void WeightTuner::decompose() {
+    Vector eigenvalues;
+    symmetricEigen(covariance_, basis_, eigenvalues);
+    for (int i = 0; i < N; ++i) {
+        scales_[i] = std::sqrt(std::max(eigenvalues[i], 1e-20));
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "Bot.hpp"
+
+class ThreadPool;
+
+struct TuneConfig {
+    int population = 0;         // candidates per generation, 0 = 4 + 3 ln(5) = 8
+    int games = 16;             // seeded games per candidate
+    int maxPieces = 1000;       // cap per game, so a strong candidate ends too
+    uint32_t seed = 1;
+    double sigma = 0.3;         // initial step size, the weights have unit length
+    // After a quarter of its games a candidate whose mean is below this
+    // fraction of the last generation's cutoff for the top half is dropped
+    double pruneFraction = 0.5;
+    BotConfig bot;              // search settings and the starting weights
+};
+
+struct TuneGeneration {
+    int generation = 0;
+    double bestFitness = 0.0;   // mean lines of the best candidate
+    double cutoff = 0.0;        // fitness of the worst candidate kept
+    double sigma = 0.0;
+    int gamesPlayed = 0;
+    int candidatesPruned = 0;
+    BotWeights best;            // best candidate of this generation
+    BotWeights mean;            // distribution mean after the update
+};
+
+// CMA-ES over the five evaluation weights. Fitness is the mean number of
+// lines a candidate clears over config.games headless games, all
+// candidates of a generation playing the same seeds. The bot only compares
+// evaluations, so scaling the weights changes nothing: candidates are
+// played and reported at unit length, and the mean is kept there.
+class WeightTuner {
+public:
+    static constexpr int DIMENSIONS = 5;
+    using Vector = std::array<double, DIMENSIONS>;
+
+    explicit WeightTuner(const TuneConfig& config);
+
+    // Sample a generation, play every game of it on pool as one shared
+    // queue of (candidate, game) tasks, and update the distribution
+    TuneGeneration step(ThreadPool& pool);
+
+    BotWeights mean() const { return toWeights(mean_); }
+    int population() const { return lambda_; }
+
+    static Vector fromWeights(const BotWeights& weights);
+    static BotWeights toWeights(const Vector& vector);
+
+private:
+    using Matrix = std::array<Vector, DIMENSIONS>;
+
+    // Candidate fitness; a pruned candidate scores the mean of its first
+    // quarter of the games
+    std::vector<double> evaluate(const std::vector<Vector>& candidates, ThreadPool& pool,
+                                 TuneGeneration& report);
+    void update(const std::vector<Vector>& candidates, const std::vector<double>& fitness);
+    // Refresh basis_ and scales_ from covariance_
+    void decompose();
+
+    TuneConfig config_;
+    std::mt19937 rng_;
+    int generation_;
+    double previousCutoff_;
+
+    // Strategy parameters, fixed by the population size
+    int lambda_;
+    int mu_;
+    std::vector<double> recombination_;
+    double muEff_;
+    double cSigma_, dSigma_, cC_, c1_, cMu_, chiN_;
+
+    // Distribution state
+    Vector mean_;
+    double sigma_;
+    Vector pathSigma_;
+    Vector pathC_;
+    Matrix covariance_;
+    Matrix basis_;      // eigenvectors of covariance_, as columns
+    Vector scales_;     // square roots of its eigenvalues
+};
@@ -0,0 +1,86 @@
+#include "Versus.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+
+namespace versus {
+
+namespace {
+
+bool isGameplay(InputAction action) {
+    return action >= InputAction::MOVE_LEFT && action <= InputAction::HARD_DROP;
+}
+
+int nextHole(VersusState& state) {
+    state.garbageRng = state.garbageRng * 1664525u + 1013904223u;
+    return static_cast<int>((state.garbageRng >> 16) % Board::WIDTH);
+}
+
+} // namespace
+
+void reset(VersusState& state, uint32_t seed) {
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        rules::reset(state.players[i], seed);
+        state.pendingGarbage[i] = 0;
+    }
+    state.garbageRng = seed;
+    state.ticks = 0;
+    state.finished = false;
+    state.winner = -1;
+}
+
+void step(VersusState& state, InputAction first, InputAction second) {
+    TRACE_SCOPE("versus::step");
+    if (state.finished) return;
+
+    // Both boards move before any garbage changes hands, so neither player
+    // sees the other's clears a tick early
+    const InputAction actions[] = {first, second};
+    StepResult results[VersusState::PLAYERS];
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        InputAction action = isGameplay(actions[i]) ? actions[i] : InputAction::NONE;
+        results[i] = rules::step(state.players[i], action);
+    }
+
+    // Clears cancel the sender's own pending rows first, the rest is sent
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        int sent = GARBAGE_FOR_LINES[results[i].linesCleared];
+        int cancelled = std::min(sent, state.pendingGarbage[i]);
+        state.pendingGarbage[i] -= cancelled;
+        state.pendingGarbage[1 - i] += sent - cancelled;
+    }
+
+    // Pending rows rise when a piece locks without clearing anything
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        if (results[i].piecesLocked > 0 && results[i].linesCleared == 0 && state.pendingGarbage[i] > 0) {
+            rules::addGarbage(state.players[i], state.pendingGarbage[i], nextHole(state));
+            state.pendingGarbage[i] = 0;
+        }
+    }
+
+    ++state.ticks;
+    bool lost[VersusState::PLAYERS];
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        lost[i] = state.players[i].status == GameStatus::GAME_OVER;
+    }
+    if (lost[0] || lost[1]) {
+        state.finished = true;
+        state.winner = lost[0] == lost[1] ? -1 : (lost[0] ? 1 : 0);
+    }
+}
+
+uint64_t hash(const VersusState& state) {
+    uint64_t h = rules::hash(state.players[0]);
+    uint64_t fields[] = {
+        rules::hash(state.players[1]),
+        uint64_t(uint32_t(state.pendingGarbage[0])) | uint64_t(uint32_t(state.pendingGarbage[1])) << 32,
+        uint64_t(state.garbageRng) | uint64_t(state.ticks) << 32,
+        uint64_t(state.finished) | uint64_t(uint8_t(state.winner)) << 8,
+    };
+    for (uint64_t field : fields) {
+        h = (h ^ field) * 0xc4ceb9fe1a85ec53ull;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+} // namespace versus
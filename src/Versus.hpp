@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include "Rules.hpp"
+
+// Two games played against each other: lines cleared on one board send
+// garbage rows to the other. Everything the match needs is in this plain
+// struct, so netplay rolls back by copying it and re-runs ticks with
+// versus::step, which is fully determined by the state and both inputs.
+struct VersusState {
+    static constexpr int PLAYERS = 2;
+
+    GameState players[PLAYERS];
+    // Garbage rows waiting to rise under each player's stack
+    int pendingGarbage[PLAYERS];
+    uint32_t garbageRng;    // picks the hole column of each garbage batch
+    uint32_t ticks;
+    bool finished;
+    int8_t winner;          // player index, -1 for a draw or while playing
+};
+
+static_assert(std::is_trivially_copyable<VersusState>::value,
+              "VersusState is saved and restored with memcpy");
+
+namespace versus {
+
+// Rows sent for clearing 0..4 lines at once
+constexpr int GARBAGE_FOR_LINES[] = {0, 0, 1, 2, 4};
+
+// Both players get the same piece sequence
+void reset(VersusState& state, uint32_t seed);
+
+// One tick for both players. Only moves, rotations and drops are applied;
+// pausing or restarting a single board is not part of a match.
+void step(VersusState& state, InputAction first, InputAction second);
+
+uint64_t hash(const VersusState& state);
+
+} // namespace versus
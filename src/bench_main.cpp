@@ -0,0 +1,476 @@
+#include "AllocationCounter.hpp"
+#include "Board.hpp"
+#include "Bot.hpp"
+#include "MoveGen.hpp"
+#include "MultiGame.hpp"
+#include "Perft.hpp"
+#include "Piece.hpp"
+#include "Policy.hpp"
+#include "Rewind.hpp"
+#include "Rules.hpp"
+#include "SoftwareRenderer.hpp"
+#include "ThreadPool.hpp"
+#include "Versus.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef TETRIS_BENCH_RENDER
+#include "Renderer.hpp"
+#endif
+
+namespace {
+
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    int samples;
+    double nsPerOp;
+    double minNsPerOp;
+    double maxNsPerOp;
+    double variance;
+    double allocsPerOp;
+};
+
+struct BenchOptions {
+    std::string filter;
+    int samples = 20;
+    double sampleSeconds = 0.01;
+};
+
+// Calibrates an iteration count so one sample takes roughly sampleSeconds,
+// then times that many calls of body per sample.
+template <typename Body>
+bool runBenchmark(const BenchOptions& options, const char* name, Body&& body,
+                  std::vector<BenchResult>& results) {
+    using Clock = std::chrono::steady_clock;
+    if (!options.filter.empty() && std::strstr(name, options.filter.c_str()) == nullptr) {
+        return false;
+    }
+
+    uint64_t iterations = 1;
+    while (true) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) body();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= options.sampleSeconds || iterations >= (1ull << 32)) break;
+        iterations *= (seconds < options.sampleSeconds / 16) ? 8 : 2;
+    }
+
+    std::vector<double> perOp;
+    perOp.reserve(options.samples);
+    // Every thread, so work handed to a pool is counted too
+    uint64_t allocationsBefore = allocs::total();
+    for (int sample = 0; sample < options.samples; ++sample) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) body();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        perOp.push_back(ns / iterations);
+    }
+    uint64_t allocations = allocs::total() - allocationsBefore;
+
+    double mean = 0.0;
+    for (double v : perOp) mean += v;
+    mean /= perOp.size();
+    double variance = 0.0;
+    for (double v : perOp) variance += (v - mean) * (v - mean);
+    variance /= perOp.size();
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.samples = options.samples;
+    result.nsPerOp = mean;
+    result.minNsPerOp = *std::min_element(perOp.begin(), perOp.end());
+    result.maxNsPerOp = *std::max_element(perOp.begin(), perOp.end());
+    result.variance = variance;
+    result.allocsPerOp = static_cast<double>(allocations) / (iterations * options.samples);
+    results.push_back(result);
+
+    std::cerr << name << ": " << mean << " ns/op" << std::endl;
+    return true;
+}
+
+// A stack with uneven column heights and a few holes, like a board in
+// the middle of a real game
+Board makeJaggedBoard() {
+    static const int heights[Board::WIDTH] = {6, 8, 5, 9, 4, 7, 3, 8, 6, 0};
+    Board board;
+    for (int x = 0; x < Board::WIDTH; ++x) {
+        for (int h = 0; h < heights[x]; ++h) {
+            int y = Board::TOTAL_ROWS - 1 - h;
+            if ((x * 7 + h * 3) % 11 == 0) continue;
+            board.setCell(x, y, 1 + (x + h) % 7);
+        }
+    }
+    return board;
+}
+
+// Four full rows at the bottom with some junk on top
+Board makeFourLineBoard() {
+    Board board;
+    for (int y = Board::TOTAL_ROWS - 4; y < Board::TOTAL_ROWS; ++y) {
+        for (int x = 0; x < Board::WIDTH; ++x) {
+            board.setCell(x, y, 1 + x % 7);
+        }
+    }
+    for (int x = 0; x < Board::WIDTH; x += 2) {
+        board.setCell(x, Board::TOTAL_ROWS - 5, 3);
+    }
+    return board;
+}
+
+// Every piece, rotation and column at a few heights, to cycle through
+std::vector<Piece> makeProbePieces() {
+    std::vector<Piece> pieces;
+    for (int type = 0; type < 7; ++type) {
+        for (int rotation = 0; rotation < 4; ++rotation) {
+            for (int x = -1; x < Board::WIDTH; ++x) {
+                for (int y = 0; y < Board::TOTAL_ROWS; y += 5) {
+                    Piece piece(static_cast<PieceType>(type));
+                    piece.setRotation(rotation);
+                    piece.setX(x);
+                    piece.setY(y);
+                    pieces.push_back(piece);
+                }
+            }
+        }
+    }
+    return pieces;
+}
+
+GameState makeMidgameState(uint32_t seed) {
+    GameState state;
+    rules::reset(state, seed);
+    state.board = makeJaggedBoard();
+    return state;
+}
+
+void runRuleBenchmarks(const BenchOptions& options, std::vector<BenchResult>& results) {
+    const Board empty;
+    const Board jagged = makeJaggedBoard();
+    const Board fourLines = makeFourLineBoard();
+    const std::vector<Piece> probes = makeProbePieces();
+
+    size_t next = 0;
+    auto nextProbe = [&]() -> const Piece& {
+        const Piece& piece = probes[next];
+        next = (next + 1 == probes.size()) ? 0 : next + 1;
+        return piece;
+    };
+
+    runBenchmark(options, "piece/get_blocks", [&] {
+        auto blocks = nextProbe().getBlocks();
+        doNotOptimize(blocks);
+    }, results);
+
+    runBenchmark(options, "can_place/empty", [&] {
+        bool fits = rules::canPlace(empty, nextProbe());
+        doNotOptimize(fits);
+    }, results);
+
+    runBenchmark(options, "can_place/jagged", [&] {
+        bool fits = rules::canPlace(jagged, nextProbe());
+        doNotOptimize(fits);
+    }, results);
+
+    // Ghost position of a freshly spawned piece
+    int spawnType = 0;
+    runBenchmark(options, "ghost/jagged", [&] {
+        Piece ghost(static_cast<PieceType>(spawnType));
+        spawnType = (spawnType + 1) % 7;
+        ghost.move(0, rules::dropDistance(jagged, ghost));
+        doNotOptimize(ghost);
+    }, results);
+
+    // Includes restoring the game state before each drop
+    const GameState midgame = makeMidgameState(1);
+    GameState state = midgame;
+    runBenchmark(options, "hard_drop/jagged", [&] {
+        state = midgame;
+        StepResult result = rules::applyAction(state, InputAction::HARD_DROP);
+        doNotOptimize(result);
+        doNotOptimize(state);
+    }, results);
+
+    // Snapshot and restore, as the bots and rewind do
+    runBenchmark(options, "state/copy", [&] {
+        state = midgame;
+        doNotOptimize(state);
+    }, results);
+
+    rules::StateBlob blob;
+    runBenchmark(options, "state/save_load", [&] {
+        rules::save(midgame, blob);
+        rules::load(blob, state);
+        doNotOptimize(state);
+    }, results);
+
+    runBenchmark(options, "state/hash", [&] {
+        uint64_t hash = rules::hash(midgame);
+        doNotOptimize(hash);
+    }, results);
+
+    // One history entry per locked piece, as the game keeps it
+    RewindBuffer history;
+    GameState played = midgame;
+    runBenchmark(options, "rewind/push", [&] {
+        rules::applyAction(played, InputAction::HARD_DROP);
+        if (played.status == GameStatus::GAME_OVER) played = midgame;
+        history.push(played);
+    }, results);
+
+    runBenchmark(options, "rewind/undo", [&] {
+        if (!history.undo(state, 1)) {
+            for (int i = 0; i < 64; ++i) history.push(midgame);
+        }
+        doNotOptimize(state);
+    }, results);
+
+    // A netplay rollback at the default prediction window: restore the
+    // match and re-run 20 ticks of both boards
+    VersusState match;
+    versus::reset(match, 1);
+    match.players[0] = midgame;
+    match.players[1] = midgame;
+    const VersusState matchStart = match;
+    const InputAction rollbackInputs[] = {InputAction::MOVE_LEFT, InputAction::NONE, InputAction::ROTATE_CW,
+                                          InputAction::NONE, InputAction::MOVE_RIGHT, InputAction::HARD_DROP};
+    runBenchmark(options, "versus/rollback_20", [&] {
+        match = matchStart;
+        for (int tick = 0; tick < 20; ++tick) {
+            versus::step(match, rollbackInputs[tick % 6], rollbackInputs[(tick + 3) % 6]);
+        }
+        doNotOptimize(match);
+    }, results);
+
+    // Each clear runs on a fresh copy of the fixture
+    const std::pair<const char*, const Board*> clearFixtures[] = {
+        {"clear_lines/empty", &empty},
+        {"clear_lines/jagged", &jagged},
+        {"clear_lines/four_lines", &fourLines},
+    };
+    for (const auto& fixture : clearFixtures) {
+        const Board& source = *fixture.second;
+        Board board;
+        runBenchmark(options, fixture.first, [&] {
+            board = source;
+            int lines = board.clearLines();
+            doNotOptimize(lines);
+            doNotOptimize(board);
+        }, results);
+    }
+
+    MoveGenerator moveGen;
+    runBenchmark(options, "move_gen/jagged", [&] {
+        Piece piece(static_cast<PieceType>(spawnType));
+        spawnType = (spawnType + 1) % 7;
+        const auto& placements = moveGen.findPlacements(jagged, piece);
+        doNotOptimize(placements);
+    }, results);
+
+    // Two pieces deep: 34 placements of the first, each followed by a search
+    Perft perft;
+    const std::vector<PieceType> perftPieces = {PieceType::L, PieceType::J};
+    runBenchmark(options, "perft/jagged_2", [&] {
+        uint64_t nodes = perft.count(jagged, perftPieces, 2);
+        doNotOptimize(nodes);
+    }, results);
+
+    Bot bot;
+    runBenchmark(options, "bot_choose/jagged", [&] {
+        const Piece pieces[] = {Piece(static_cast<PieceType>(spawnType)),
+                                Piece(static_cast<PieceType>((spawnType + 3) % 7))};
+        spawnType = (spawnType + 1) % 7;
+        Piece choice = bot.choose(jagged, pieces, 2);
+        doNotOptimize(choice);
+    }, results);
+}
+
+// A spectator wall: 100 boards, each tick one bot action per board and a
+// gravity sweep over all of them
+MultiGame makeBotWall(int boards) {
+    MultiGame wall(boards, 1);
+    wall.setAutoRestart(true);
+    for (int i = 0; i < boards; ++i) {
+        wall.setPolicy(i, createPolicy("bot", static_cast<uint32_t>(i)));
+    }
+    return wall;
+}
+
+void runWallBenchmarks(const BenchOptions& options, std::vector<BenchResult>& results) {
+    MultiGame idle(100, 1);
+    runBenchmark(options, "wall/tick_100_idle", [&] {
+        StepResult result = idle.tick();
+        doNotOptimize(result);
+    }, results);
+
+    MultiGame bots = makeBotWall(100);
+    runBenchmark(options, "wall/tick_100_bots", [&] {
+        StepResult result = bots.tick();
+        doNotOptimize(result);
+    }, results);
+
+    // Same boards, policies spread over every hardware thread
+    MultiGame pooledBots = makeBotWall(100);
+    ThreadPool pool;
+    pooledBots.setThreadPool(&pool);
+    runBenchmark(options, "wall/tick_100_bots_pool", [&] {
+        StepResult result = pooledBots.tick();
+        doNotOptimize(result);
+    }, results);
+
+    SoftwareRenderer renderer;
+    runBenchmark(options, "soft_render/wall_100", [&] {
+        renderer.drawWall(bots);
+        doNotOptimize(renderer.frame());
+    }, results);
+}
+
+void runSoftwareRenderBenchmarks(const BenchOptions& options, std::vector<BenchResult>& results) {
+    SoftwareRenderer renderer;
+    const std::pair<const char*, GameState> frames[] = {
+        {"soft_render/empty", [] { GameState s; rules::reset(s, 1); return s; }()},
+        {"soft_render/jagged", makeMidgameState(1)},
+    };
+    for (const auto& frame : frames) {
+        const GameState& state = frame.second;
+        runBenchmark(options, frame.first, [&] {
+            renderer.drawGame(state);
+            doNotOptimize(renderer.frame());
+        }, results);
+    }
+
+    // A cell flips every frame, so the board layer is redrawn each time
+    GameState dirty = makeMidgameState(1);
+    int flip = 0;
+    runBenchmark(options, "soft_render/jagged_redraw", [&] {
+        flip ^= 1;
+        dirty.board.setCell(0, 0, flip);
+        renderer.drawGame(dirty);
+        doNotOptimize(renderer.frame());
+    }, results);
+}
+
+#ifdef TETRIS_BENCH_RENDER
+void runRenderBenchmarks(const BenchOptions& options, std::vector<BenchResult>& results) {
+    SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, 600, 700, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (!target) {
+        std::cerr << "Could not create offscreen surface: " << SDL_GetError() << std::endl;
+        return;
+    }
+
+    {
+        Renderer renderer;
+        if (!renderer.initializeOffscreen(target)) {
+            std::cerr << "Could not create offscreen renderer: " << SDL_GetError() << std::endl;
+        } else {
+            const std::pair<const char*, GameState> frames[] = {
+                {"render_frame/empty", [] { GameState s; rules::reset(s, 1); return s; }()},
+                {"render_frame/jagged", makeMidgameState(1)},
+            };
+            for (const auto& frame : frames) {
+                const GameState& state = frame.second;
+                runBenchmark(options, frame.first, [&] {
+                    renderer.clear();
+                    renderer.drawGame(state);
+                    renderer.present();
+                }, results);
+            }
+        }
+    }
+    SDL_FreeSurface(target);
+}
+#endif
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "    {\"name\": \"" << jsonEscape(r.name) << "\""
+            << ", \"iterations\": " << r.iterations
+            << ", \"samples\": " << r.samples
+            << ", \"ns_per_op\": " << r.nsPerOp
+            << ", \"ns_per_op_min\": " << r.minNsPerOp
+            << ", \"ns_per_op_max\": " << r.maxNsPerOp
+            << ", \"ns_per_op_variance\": " << r.variance
+            << ", \"ns_per_op_stddev\": " << std::sqrt(r.variance)
+            << ", \"allocs_per_op\": " << r.allocsPerOp << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "  --filter TEXT    Only run benchmarks whose name contains TEXT" << std::endl;
+    std::cout << "  --samples N      Timed samples per benchmark (default 20)" << std::endl;
+    std::cout << "  --out FILE       Write JSON results to FILE instead of stdout" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    std::string outPath;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--samples") == 0 && hasValue) {
+            options.samples = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    runRuleBenchmarks(options, results);
+    runWallBenchmarks(options, results);
+    runSoftwareRenderBenchmarks(options, results);
+#ifdef TETRIS_BENCH_RENDER
+    runRenderBenchmarks(options, results);
+#endif
+
+    if (outPath.empty()) {
+        writeJson(std::cout, results);
+    } else {
+        std::ofstream out(outPath);
+        if (!out) {
+            std::cerr << "Could not open " << outPath << std::endl;
+            return 1;
+        }
+        writeJson(out, results);
+    }
+    return 0;
+}
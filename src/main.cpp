@@ -1,11 +1,90 @@
 #include "Game.hpp"
+#include "Replay.hpp"
+#include "Trace.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
-    
     Game game;
+    NetplayConfig netplay;
+    bool netplayEnabled = false;
+    
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--demo") == 0) {
+            game.setDemoMode(true);
+        } else if (std::strcmp(argv[i], "--no-vsync") == 0) {
+            game.setVsync(false);
+        } else if (std::strcmp(argv[i], "--show-stats") == 0) {
+            game.setShowStats(true);
+        } else if (std::strcmp(argv[i], "--stats-csv") == 0 && i + 1 < argc) {
+            game.setStatsCsvPath(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rewind-mb") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            char* end = nullptr;
+            long megabytes = std::strtol(value, &end, 10);
+            if (end == value || *end != '\0' || megabytes <= 0 ||
+                static_cast<unsigned long>(megabytes) > (RewindBuffer::MAX_CAPACITY >> 20)) {
+                std::cerr << "--rewind-mb takes 1 to " << (RewindBuffer::MAX_CAPACITY >> 20)
+                          << " megabytes: " << value << std::endl;
+                return 1;
+            }
+            game.setRewindCapacity(static_cast<size_t>(megabytes) << 20);
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            game.setTracePath(argv[++i]);
+        } else if (std::strcmp(argv[i], "--wall") == 0 && i + 1 < argc) {
+            game.setWall(std::max(1, std::atoi(argv[++i])));
+        } else if (std::strcmp(argv[i], "--versus") == 0) {
+            game.setVersus(true);
+        } else if (std::strcmp(argv[i], "--netplay") == 0 && i + 2 < argc) {
+            netplay.localPort = static_cast<uint16_t>(std::atoi(argv[++i]));
+            netplay.remotePort = static_cast<uint16_t>(std::atoi(argv[++i]));
+            netplayEnabled = true;
+        } else if (std::strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+            netplay.localPlayer = std::atoi(argv[++i]) == 2 ? 1 : 0;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            netplay.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc) {
+            netplay.inputDelay = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--net-latency") == 0 && i + 1 < argc) {
+            netplay.link.latencyMs = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--net-jitter") == 0 && i + 1 < argc) {
+            netplay.link.jitterMs = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--net-loss") == 0 && i + 1 < argc) {
+            netplay.link.lossPercent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            game.setRecordPath(argv[++i]);
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            Replay replay;
+            if (!loadReplay(argv[++i], replay)) {
+                std::cerr << "Cannot read replay: " << argv[i] << std::endl;
+                return 1;
+            }
+            game.setReplay(replay);
+        } else if (std::strcmp(argv[i], "--randomizer") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "bag") == 0) {
+                game.setRandomizer(Randomizer::BAG);
+            } else if (std::strcmp(name, "uniform") == 0) {
+                game.setRandomizer(Randomizer::UNIFORM);
+            } else {
+                std::cerr << "Unknown randomizer: " << name << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--weights") == 0 && i + 1 < argc) {
+            BotWeights weights;
+            if (!loadWeights(argv[++i], weights)) {
+                std::cerr << "Cannot read weights: " << argv[i] << std::endl;
+                return 1;
+            }
+            game.setBotWeights(weights);
+        }
+    }
+    
+    if (netplayEnabled) {
+        game.setNetplay(netplay);
+    }
     
     if (!game.initialize()) {
         std::cerr << "Failed to initialize game!" << std::endl;
@@ -20,6 +99,17 @@ int main(int argc, char* argv[]) {
     std::cout << "  Up/Z             - Rotate" << std::endl;
     std::cout << "  Space            - Hard drop" << std::endl;
     std::cout << "  P                - Pause/Resume" << std::endl;
+    std::cout << "  R (hold)         - Rewind" << std::endl;
+    std::cout << "  B                - Toggle demo mode" << std::endl;
+    std::cout << "  --versus         - Race a bot on the same pieces" << std::endl;
+    std::cout << "  --wall N         - Watch N bot games at once" << std::endl;
+    std::cout << "  --randomizer R   - Piece order: uniform or bag (7-bag)" << std::endl;
+    std::cout << "  --netplay L R    - Versus over UDP ports L (ours) and R (theirs)," << std::endl;
+    std::cout << "                     with --player 1|2 and the same --seed on both" << std::endl;
+    std::cout << "  F3               - Toggle frame timing overlay" << std::endl;
+    if (trace::ENABLED) {
+        std::cout << "  F4               - Write trace JSON" << std::endl;
+    }
     std::cout << "  Escape           - Quit" << std::endl;
     std::cout << std::endl;
     
@@ -0,0 +1,181 @@
+#include "Netplay.hpp"
+#include "Policy.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "Plays both peers of a versus match over 127.0.0.1 and checks they agree." << std::endl;
+    std::cout << "  --ticks N          Ticks to play, 0 = until a player tops out (default 3600)" << std::endl;
+    std::cout << "  --seed S           Match seed (default 1)" << std::endl;
+    std::cout << "  --port P           UDP ports P and P + 1 (default 47000)" << std::endl;
+    std::cout << "  --latency MS       Injected one-way delay (default 40)" << std::endl;
+    std::cout << "  --jitter MS        Extra random delay, 0..MS (default 10)" << std::endl;
+    std::cout << "  --loss PCT         Packets dropped, in percent (default 5)" << std::endl;
+    std::cout << "  --input-delay N    Ticks before a local input applies (default 2)" << std::endl;
+    std::cout << "  --max-prediction N Ticks run ahead of the remote input (default 20)" << std::endl;
+    std::cout << "  --policy NAME      Input for both players: random, drop, bot (default random)" << std::endl;
+    std::cout << "  --tps N            Ticks per second, 0 = as fast as possible (default 60)" << std::endl;
+}
+
+struct Peer {
+    UdpLink link;
+    std::unique_ptr<RollbackSession> session;
+    std::unique_ptr<Policy> policy;
+};
+
+void printStats(int player, const Peer& peer, double seconds) {
+    const NetplayStats& stats = peer.session->stats();
+    double rollbackMs = stats.rollbackNanos / 1e6;
+    std::cout << "peer " << player
+              << "  rollbacks " << stats.rollbacks
+              << "  re-run ticks " << stats.resimulatedTicks
+              << "  max depth " << stats.maxRollback
+              << "  mean " << (stats.rollbacks ? rollbackMs * 1000.0 / stats.rollbacks : 0.0) << " us"
+              << "  re-run ticks/sec " << (rollbackMs > 0.0 ? stats.resimulatedTicks / (rollbackMs / 1000.0) : 0.0)
+              << "  stalls " << stats.stalls
+              << "  packets " << peer.link.sent() << " sent, " << peer.link.dropped() << " dropped"
+              << "  checks " << stats.checks << " (" << stats.desyncs << " desynced)"
+              << "  " << seconds << " s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    NetplayConfig config;
+    config.link.latencyMs = 40;
+    config.link.jitterMs = 10;
+    config.link.lossPercent = 5.0;
+    uint32_t ticks = 3600;
+    int port = 47000;
+    int ticksPerSecond = rules::TICKS_PER_SECOND;
+    std::string policy = "random";
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            ticks = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--port") == 0 && hasValue) {
+            port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--latency") == 0 && hasValue) {
+            config.link.latencyMs = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--jitter") == 0 && hasValue) {
+            config.link.jitterMs = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--loss") == 0 && hasValue) {
+            config.link.lossPercent = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--input-delay") == 0 && hasValue) {
+            config.inputDelay = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-prediction") == 0 && hasValue) {
+            config.maxPrediction = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--policy") == 0 && hasValue) {
+            policy = argv[++i];
+        } else if (std::strcmp(argv[i], "--tps") == 0 && hasValue) {
+            ticksPerSecond = std::max(0, std::atoi(argv[++i]));
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (port <= 0 || port + 1 > 65535) {
+        std::cerr << "--port must leave room for two ports below 65536" << std::endl;
+        return 1;
+    }
+    if (!createPolicy(policy, 0)) {
+        std::cerr << "Unknown policy: " << policy << std::endl;
+        return 1;
+    }
+
+    Peer peers[VersusState::PLAYERS];
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        NetplayConfig peerConfig = config;
+        peerConfig.localPlayer = i;
+        peerConfig.localPort = static_cast<uint16_t>(port + i);
+        peerConfig.remotePort = static_cast<uint16_t>(port + 1 - i);
+        peerConfig.link.seed = config.seed * 2 + static_cast<uint32_t>(i);
+        if (!peers[i].link.open(peerConfig.localPort, peerConfig.remotePort, peerConfig.link)) {
+            std::cerr << "Cannot open UDP port " << peerConfig.localPort << std::endl;
+            return 1;
+        }
+        peers[i].session = std::make_unique<RollbackSession>(peers[i].link, peerConfig);
+        peers[i].policy = createPolicy(policy, config.seed + static_cast<uint32_t>(i));
+    }
+
+    // Each peer runs on its own clock, as two machines would; they only
+    // meet through the sockets
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    auto lastProgress = start;
+    uint32_t lastConfirmed = 0;
+    // Judged on confirmed states only: a predicted top-out can still be
+    // rolled back
+    auto done = [&](const Peer& peer) {
+        const RollbackSession& session = *peer.session;
+        return session.confirmedState().finished || (ticks > 0 && session.confirmedTick() >= ticks);
+    };
+
+    while (!done(peers[0]) || !done(peers[1])) {
+        uint64_t due = ~uint64_t(0);
+        if (ticksPerSecond > 0) {
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            due = static_cast<uint64_t>(elapsed * ticksPerSecond) + 1;
+        }
+
+        for (Peer& peer : peers) {
+            RollbackSession& session = *peer.session;
+            session.poll();
+            // A finished match keeps ticking, as a no-op, until the peer has
+            // the inputs to confirm it
+            bool running = !done(peer) && (ticks == 0 || session.tick() < ticks);
+            if (running && session.tick() < due && session.canAdvance()) {
+                // The input lands after the input delay, so the policy looks
+                // at the board as it will be then
+                const VersusState ahead = session.scheduledState();
+                session.advance(peer.policy->nextAction(ahead.players[session.localPlayer()]));
+            }
+        }
+
+        uint32_t confirmed = std::min(peers[0].session->confirmedTick(), peers[1].session->confirmedTick());
+        if (confirmed != lastConfirmed) {
+            lastConfirmed = confirmed;
+            lastProgress = Clock::now();
+        } else if (Clock::now() - lastProgress > std::chrono::seconds(5)) {
+            std::cerr << "No progress for 5 s, are the ports free?" << std::endl;
+            return 1;
+        }
+        if (ticksPerSecond > 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const VersusState& first = peers[0].session->confirmedState();
+    const VersusState& second = peers[1].session->confirmedState();
+    bool agree = versus::hash(first) == versus::hash(second);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << first.ticks << " ticks, seed " << config.seed << ", latency " << config.link.latencyMs
+              << " ms + jitter " << config.link.jitterMs << " ms, loss " << config.link.lossPercent
+              << "%, input delay " << config.inputDelay << ", policy " << policy << std::endl;
+    for (int i = 0; i < VersusState::PLAYERS; ++i) {
+        printStats(i, peers[i], seconds);
+    }
+    std::cout << "scores " << first.players[0].score << " / " << first.players[1].score;
+    if (first.finished) {
+        std::cout << (first.winner < 0 ? ", draw" : first.winner == 0 ? ", player 0 wins" : ", player 1 wins");
+    }
+    std::cout << std::endl;
+    std::cout << (agree ? "final states agree" : "final states DIFFER") << std::endl;
+
+    uint64_t desyncs = peers[0].session->stats().desyncs + peers[1].session->stats().desyncs;
+    return agree && desyncs == 0 ? 0 : 1;
+}
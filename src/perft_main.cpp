@@ -0,0 +1,175 @@
+#include "Perft.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "Counts the lock positions reachable by a sequence of pieces. Without a" << std::endl;
+    std::cout << "position or board, checks every reference position against its known counts." << std::endl;
+    std::cout << "  --position NAME  Reference position: ";
+    for (const PerftPosition& position : perftPositions()) std::cout << position.name << " ";
+    std::cout << std::endl;
+    std::cout << "  --board ROWS     Rows from the top down on the floor, '/' between rows, '.' empty" << std::endl;
+    std::cout << "  --pieces SEQ     Piece letters, repeated as needed (default TIOLJSZ)" << std::endl;
+    std::cout << "  --depth N        Pieces to place, reported for every depth up to N (default 3;" << std::endl;
+    std::cout << "                   the check runs every depth with a known count)" << std::endl;
+    std::cout << "  --20g            Pieces drop to rest after every move, as under 20G" << std::endl;
+    std::cout << "  --divide         Also print the count under each placement of the first piece" << std::endl;
+    std::cout << "  --threads T      Worker threads, 0 = all cores (default 0)" << std::endl;
+}
+
+struct Run {
+    uint64_t nodes;
+    double seconds;
+};
+
+Run timedPerft(ThreadPool& pool, const Board& board, const std::vector<PieceType>& pieces, int depth,
+               bool instantGravity, std::vector<PerftDivide>* divide) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t nodes = perftParallel(pool, board, pieces, depth, instantGravity, divide);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return Run{nodes, seconds};
+}
+
+void printRun(int depth, const Run& run) {
+    std::cout << std::fixed << std::setprecision(3)
+              << "depth " << std::setw(2) << depth
+              << "  nodes " << std::setw(12) << run.nodes
+              << "  " << std::setw(8) << run.seconds << " s"
+              << std::setprecision(0)
+              << "  nodes/sec " << (run.seconds > 0.0 ? run.nodes / run.seconds : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const PerftPosition* position = nullptr;
+    std::string rows;
+    std::string letters = "TIOLJSZ";
+    bool custom = false;
+    int depth = 0;
+    bool instantGravity = false;
+    bool divide = false;
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--position") == 0 && hasValue) {
+            const char* name = argv[++i];
+            position = nullptr;
+            for (const PerftPosition& candidate : perftPositions()) {
+                if (std::strcmp(candidate.name, name) == 0) position = &candidate;
+            }
+            if (!position) {
+                std::cerr << "Unknown position: " << name << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--board") == 0 && hasValue) {
+            rows = argv[++i];
+            custom = true;
+        } else if (std::strcmp(argv[i], "--pieces") == 0 && hasValue) {
+            letters = argv[++i];
+            custom = true;
+        } else if (std::strcmp(argv[i], "--depth") == 0 && hasValue) {
+            depth = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--20g") == 0) {
+            instantGravity = true;
+        } else if (std::strcmp(argv[i], "--divide") == 0) {
+            divide = true;
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (position && custom) {
+        std::cerr << "--position cannot be combined with --board or --pieces" << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+
+    if (!position && !custom) {
+        // Every reference position at every depth with a known count
+        uint64_t totalNodes = 0;
+        double totalSeconds = 0.0;
+        int failures = 0;
+        for (const PerftPosition& reference : perftPositions()) {
+            Board board;
+            std::vector<PieceType> pieces;
+            parsePerftBoard(reference.rows, board);
+            parsePerftPieces(reference.pieces, pieces);
+            int maxDepth = static_cast<int>(reference.expected.size());
+            if (depth > 0) maxDepth = std::min(maxDepth, depth);
+
+            std::cout << reference.name << std::endl;
+            for (int d = 1; d <= maxDepth; ++d) {
+                Run run = timedPerft(pool, board, pieces, d, reference.instantGravity, nullptr);
+                bool ok = run.nodes == reference.expected[d - 1];
+                failures += !ok;
+                totalNodes += run.nodes;
+                totalSeconds += run.seconds;
+                printRun(d, run);
+                if (ok) {
+                    std::cout << "  ok" << std::endl;
+                } else {
+                    std::cout << "  MISMATCH, expected " << reference.expected[d - 1] << std::endl;
+                }
+            }
+        }
+        std::cout << std::setprecision(0) << totalNodes << " nodes, " << pool.size() << " threads, "
+                  << (totalSeconds > 0.0 ? totalNodes / totalSeconds : 0.0) << " nodes/sec, "
+                  << failures << " mismatches" << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+
+    if (position) {
+        rows = position->rows;
+        letters = position->pieces;
+        instantGravity = position->instantGravity;
+    }
+    Board board;
+    if (!parsePerftBoard(rows, board)) {
+        std::cerr << "Bad board, expected up to " << Board::TOTAL_ROWS << " rows of " << Board::WIDTH
+                  << " cells: " << rows << std::endl;
+        return 1;
+    }
+    std::vector<PieceType> pieces;
+    if (!parsePerftPieces(letters, pieces)) {
+        std::cerr << "Bad piece sequence, expected letters from IOTSZJL: " << letters << std::endl;
+        return 1;
+    }
+    if (depth == 0) depth = 3;
+
+    std::vector<PerftDivide> roots;
+    for (int d = 1; d <= depth; ++d) {
+        Run run = timedPerft(pool, board, pieces, d, instantGravity, divide && d == depth ? &roots : nullptr);
+        printRun(d, run);
+        if (position && d <= static_cast<int>(position->expected.size())) {
+            uint64_t expected = position->expected[d - 1];
+            if (run.nodes == expected) {
+                std::cout << "  ok";
+            } else {
+                std::cout << "  MISMATCH, expected " << expected;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    for (const PerftDivide& root : roots) {
+        const Piece& piece = root.placement;
+        std::cout << "  rotation " << piece.getRotation() << "  x " << std::setw(2) << piece.getX()
+                  << "  y " << std::setw(2) << piece.getY() << "  " << root.nodes << std::endl;
+    }
+    return 0;
+}
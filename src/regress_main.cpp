@@ -0,0 +1,97 @@
+#include "MoveGen.hpp"
+#include "Policy.hpp"
+#include "Rules.hpp"
+#include <iostream>
+#include <limits>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* check, const char* what) {
+    if (!condition) {
+        std::cout << "FAILED " << check << ": " << what << std::endl;
+        ++failures;
+    }
+}
+
+// Garbage that reaches the spawn rows lifts the piece against the ceiling.
+// The rules must top out there rather than move it above row 0, where the
+// placement search has no states.
+void ceilingLiftTopsOut() {
+    const char* check = "ceiling_lift_tops_out";
+    GameState state;
+    rules::reset(state, 1);
+    // Garbage up to the row under the spawned piece, then one row more
+    rules::addGarbage(state, Board::TOTAL_ROWS - 2, 0);
+    expect(state.status == GameStatus::PLAYING, check, "garbage below the piece ends the game");
+    rules::addGarbage(state, 1, 0);
+    expect(state.status == GameStatus::GAME_OVER, check, "no room to lift is not a top-out");
+    expect(state.current.getY() >= 0, check, "piece lifted above row 0");
+
+    MoveGenerator moveGen;
+    expect(moveGen.findPlacements(state.board, state.current).empty(), check,
+           "placements found for a piece stuck in the stack");
+    auto bot = createPolicy("bot", 1);
+    expect(bot->nextAction(state) == InputAction::HARD_DROP, check, "bot plans a path with no placements");
+}
+
+// With room above, the piece rises just enough and the search carries on
+void partialLiftKeepsPlaying() {
+    const char* check = "partial_lift_keeps_playing";
+    GameState state;
+    rules::reset(state, 1);
+    state.current.move(0, 5);
+    int bottom = state.current.getY() + state.current.getMask().maxY;
+    rules::addGarbage(state, Board::TOTAL_ROWS - 1 - bottom, 0);
+    rules::addGarbage(state, 1, 0);
+    expect(state.status == GameStatus::PLAYING, check, "a one-row lift ends the game");
+    expect(state.current.getY() == 4, check, "piece not lifted by exactly one row");
+    expect(rules::canPlace(state.board, state.current), check, "lifted piece overlaps the stack");
+
+    MoveGenerator moveGen;
+    const std::vector<Piece>& placements = moveGen.findPlacements(state.board, state.current);
+    expect(!placements.empty(), check, "no placements after the lift");
+    for (const Piece& placement : placements) {
+        expect(placement.getY() >= 0 && rules::canPlace(state.board, placement), check,
+               "placement off the board or in the stack");
+    }
+    auto bot = createPolicy("bot", 1);
+    expect(bot->nextAction(state) != InputAction::NONE, check, "bot has no move after the lift");
+}
+
+// Starts the search has no states for come back empty instead of indexing
+// outside them
+void searchRejectsOutsideStarts() {
+    const char* check = "search_rejects_outside_starts";
+    MoveGenerator moveGen;
+    Piece above(PieceType::T);
+    above.setY(-1);
+    expect(moveGen.findPlacements(Board(), above).empty(), check, "placements from above row 0");
+    std::vector<InputAction> path;
+    expect(!moveGen.findPath(Board(), above, Piece(PieceType::T), path), check, "path from above row 0");
+    expect(moveGen.findPlacements(Board(), Piece()).empty(), check, "placements for no piece");
+}
+
+// Uncapped bot games reach scores past the range of int
+void scoreSaturates() {
+    const char* check = "score_saturates";
+    GameState state;
+    rules::reset(state, 1);
+    state.score = std::numeric_limits<int>::max() - 10;
+    rules::applyAction(state, InputAction::HARD_DROP);
+    expect(state.score == std::numeric_limits<int>::max(), check, "score did not stop at the largest int");
+}
+
+} // namespace
+
+int main() {
+    ceilingLiftTopsOut();
+    partialLiftKeepsPlaying();
+    searchRejectsOutsideStarts();
+    scoreSaturates();
+
+    std::cout << (failures == 0 ? "all checks passed" : "checks failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#include "Replay.hpp"
+#include "SoftwareRenderer.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options] FILE..." << std::endl;
+    std::cout << "  --threads T      Worker threads, 0 = all cores (default 0)" << std::endl;
+    std::cout << "  --repeat N       Play the whole set N times, for benchmarking (default 1)" << std::endl;
+    std::cout << "  --thumbnails DIR Save the final frame of each replay as a half-size PNG in DIR" << std::endl;
+}
+
+struct Playback {
+    Replay replay;
+    ReplayTrailer played;
+};
+
+std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.rfind('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+bool saveThumbnail(const Replay& replay, const std::string& path) {
+    GameState state;
+    playReplay(replay, state);
+    SoftwareRenderer renderer;
+    renderer.drawGame(state);
+    return renderer.frame().downscaled(2).savePNG(path);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned threads = 0;
+    int repeat = 1;
+    std::string thumbnailDir;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--repeat") == 0 && hasValue) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--thumbnails") == 0 && hasValue) {
+            thumbnailDir = argv[++i];
+        } else if (argv[i][0] == '-') {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    if (paths.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Playback> playbacks(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!loadReplay(paths[i], playbacks[i].replay)) {
+            std::cerr << "Cannot read replay: " << paths[i] << std::endl;
+            return 1;
+        }
+    }
+
+    ThreadPool pool(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; ++r) {
+        for (Playback& playback : playbacks) {
+            pool.submit([&playback] { playback.played = playReplay(playback.replay); });
+        }
+        pool.wait();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int mismatches = 0;
+    uint64_t totalTicks = 0;
+    for (size_t i = 0; i < playbacks.size(); ++i) {
+        const ReplayTrailer& expected = playbacks[i].replay.trailer;
+        const ReplayTrailer& played = playbacks[i].played;
+        totalTicks += played.ticks;
+        if (played != expected) {
+            ++mismatches;
+            std::cout << "MISMATCH " << paths[i]
+                      << ": score " << played.score << "/" << expected.score
+                      << ", lines " << played.lines << "/" << expected.lines
+                      << ", pieces " << played.pieces << "/" << expected.pieces
+                      << ", ticks " << played.ticks << "/" << expected.ticks << std::endl;
+        }
+    }
+    totalTicks *= repeat;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << playbacks.size() * repeat << " replays, " << pool.size() << " threads, "
+              << seconds << " s" << std::endl;
+    std::cout << std::setprecision(1);
+    std::cout << "replays/sec " << playbacks.size() * repeat / seconds << std::endl;
+    std::cout << "ticks/sec   " << totalTicks / seconds << std::endl;
+    std::cout << (playbacks.size() - mismatches) << "/" << playbacks.size() << " verified" << std::endl;
+
+    if (!thumbnailDir.empty()) {
+        std::vector<char> saved(playbacks.size(), 0);
+        for (size_t i = 0; i < playbacks.size(); ++i) {
+            std::string path = thumbnailDir + "/" + baseName(paths[i]) + ".png";
+            pool.submit([&playbacks, &saved, path, i] {
+                saved[i] = saveThumbnail(playbacks[i].replay, path);
+            });
+        }
+        pool.wait();
+        for (size_t i = 0; i < playbacks.size(); ++i) {
+            if (!saved[i]) std::cerr << "Could not write thumbnail for " << paths[i] << std::endl;
+        }
+    }
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,156 @@
+#include "AllocationCounter.hpp"
+#include "Policy.hpp"
+#include "Simulator.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "  --games N        Number of games to play (default 100)" << std::endl;
+    std::cout << "  --seed S         Seed of the first game, game i uses S + i (default 1)" << std::endl;
+    std::cout << "  --threads T      Worker threads, 0 = all cores (default 0)" << std::endl;
+    std::cout << "  --policy NAME    Move policy: random, drop, bot (default drop)" << std::endl;
+    std::cout << "  --randomizer R   Piece order: bag (7-bag) or uniform (default bag)" << std::endl;
+    std::cout << "  --max-pieces N   Stop each game after N pieces, 0 = no limit (default 0)" << std::endl;
+    std::cout << "  --beam-width N   Boards the bot keeps per lookahead level (default 4)" << std::endl;
+    std::cout << "  --depth N        Pieces the bot searches, current + preview (default 2)" << std::endl;
+    std::cout << "  --weights PATH   Bot evaluation weights, as written by tetris-tune" << std::endl;
+    std::cout << "  --record DIR     Save each game to DIR/<seed>.replay" << std::endl;
+    std::cout << "  --check-allocs   Fail if a tick allocates after warm-up (TETRIS_COUNT_ALLOCS builds)" << std::endl;
+}
+
+void printDistribution(const char* name, std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+
+    double sum = 0.0;
+    for (double v : values) sum += v;
+    double mean = sum / values.size();
+
+    double variance = 0.0;
+    for (double v : values) variance += (v - mean) * (v - mean);
+    double stddev = std::sqrt(variance / values.size());
+
+    auto percentile = [&values](double p) {
+        size_t index = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        return values[index];
+    };
+
+    std::cout << std::left << std::setw(8) << name << std::right
+              << " mean " << std::setw(10) << mean
+              << "  sd " << std::setw(10) << stddev
+              << "  min " << std::setw(8) << values.front()
+              << "  p25 " << std::setw(8) << percentile(0.25)
+              << "  p50 " << std::setw(8) << percentile(0.50)
+              << "  p75 " << std::setw(8) << percentile(0.75)
+              << "  p99 " << std::setw(8) << percentile(0.99)
+              << "  max " << std::setw(8) << values.back() << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    SimConfig config;
+    unsigned threads = 0;
+    bool checkAllocations = false;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--games") == 0 && hasValue) {
+            config.games = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--policy") == 0 && hasValue) {
+            config.policy = argv[++i];
+        } else if (std::strcmp(argv[i], "--randomizer") == 0 && hasValue) {
+            const char* name = argv[++i];
+            if (std::strcmp(name, "bag") == 0) {
+                config.randomizer = Randomizer::BAG;
+            } else if (std::strcmp(name, "uniform") == 0) {
+                config.randomizer = Randomizer::UNIFORM;
+            } else {
+                std::cerr << "Unknown randomizer: " << name << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--max-pieces") == 0 && hasValue) {
+            config.maxPieces = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--beam-width") == 0 && hasValue) {
+            config.bot.beamWidth = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--depth") == 0 && hasValue) {
+            config.bot.depth = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--weights") == 0 && hasValue) {
+            const char* path = argv[++i];
+            if (!loadWeights(path, config.bot.weights)) {
+                std::cerr << "Cannot read weights: " << path << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+            config.recordDir = argv[++i];
+        } else if (std::strcmp(argv[i], "--check-allocs") == 0) {
+            checkAllocations = true;
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (config.games <= 0) {
+        std::cerr << "--games must be positive" << std::endl;
+        return 1;
+    }
+    if (checkAllocations && !allocs::ENABLED) {
+        std::cerr << "--check-allocs needs a build configured with -DTETRIS_COUNT_ALLOCS=ON" << std::endl;
+        return 1;
+    }
+    if (!createPolicy(config.policy, 0)) {
+        std::cerr << "Unknown policy: " << config.policy << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<GameResult> results = runGames(config, pool);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t totalPieces = 0;
+    uint64_t totalTicks = 0;
+    uint64_t totalAllocations = 0;
+    std::vector<double> scores;
+    std::vector<double> lines;
+    std::vector<double> pieces;
+    for (const auto& result : results) {
+        totalPieces += result.pieces;
+        totalTicks += result.ticks;
+        totalAllocations += result.allocations;
+        scores.push_back(result.score);
+        lines.push_back(result.lines);
+        pieces.push_back(result.pieces);
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << config.games << " games, policy " << config.policy
+              << ", " << pool.size() << " threads, " << seconds << " s" << std::endl;
+    std::cout << std::setprecision(1);
+    std::cout << "games/sec  " << config.games / seconds << std::endl;
+    std::cout << "pieces/sec " << totalPieces / seconds << std::endl;
+    std::cout << "ticks/sec  " << totalTicks / seconds << std::endl;
+    printDistribution("score", scores);
+    printDistribution("lines", lines);
+    printDistribution("pieces", pieces);
+    if (allocs::ENABLED) {
+        std::cout << "allocations after warm-up " << totalAllocations << std::endl;
+    }
+
+    return checkAllocations && totalAllocations > 0 ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+#include "ThreadPool.hpp"
+#include "Tuner.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "  --generations N  CMA-ES generations to run (default 30)" << std::endl;
+    std::cout << "  --population N   Candidates per generation, 0 = 8 (default 0)" << std::endl;
+    std::cout << "  --games N        Seeded games per candidate (default 16)" << std::endl;
+    std::cout << "  --max-pieces N   Pieces per game at most (default 1000)" << std::endl;
+    std::cout << "  --seed S         Seed of the sampling and of the games (default 1)" << std::endl;
+    std::cout << "  --sigma X        Initial step size on the unit weight vector (default 0.3)" << std::endl;
+    std::cout << "  --prune F        Drop candidates below F x the last cutoff, 0 = never (default 0.5)" << std::endl;
+    std::cout << "  --threads T      Worker threads, 0 = all cores (default 0)" << std::endl;
+    std::cout << "  --beam-width N   Boards the bot keeps per lookahead level (default 1)" << std::endl;
+    std::cout << "  --depth N        Pieces the bot searches, current + preview (default 1)" << std::endl;
+    std::cout << "  --start PATH     Weights file to start from (default: built-in weights)" << std::endl;
+    std::cout << "  --out PATH       Where the tuned weights go (default bot.weights)" << std::endl;
+}
+
+void printWeights(const BotWeights& w) {
+    std::cout << "height " << w.height << "  holes " << w.holes << "  bumpiness " << w.bumpiness
+              << "  wells " << w.wells << "  lines " << w.lines;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TuneConfig config;
+    // A shallow bot tops out within the piece cap, so candidates still
+    // differ; the weights carry over to deeper searches
+    config.bot.beamWidth = 1;
+    config.bot.depth = 1;
+    int generations = 30;
+    unsigned threads = 0;
+    std::string outPath = "bot.weights";
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--generations") == 0 && hasValue) {
+            generations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--population") == 0 && hasValue) {
+            config.population = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--games") == 0 && hasValue) {
+            config.games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--max-pieces") == 0 && hasValue) {
+            config.maxPieces = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--sigma") == 0 && hasValue) {
+            config.sigma = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--prune") == 0 && hasValue) {
+            config.pruneFraction = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--beam-width") == 0 && hasValue) {
+            config.bot.beamWidth = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--depth") == 0 && hasValue) {
+            config.bot.depth = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--start") == 0 && hasValue) {
+            const char* path = argv[++i];
+            if (!loadWeights(path, config.bot.weights)) {
+                std::cerr << "Cannot read weights: " << path << std::endl;
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--out") == 0 && hasValue) {
+            outPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    if (generations <= 0) {
+        std::cerr << "--generations must be positive" << std::endl;
+        return 1;
+    }
+    if (config.sigma <= 0.0) {
+        std::cerr << "--sigma must be positive" << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    WeightTuner tuner(config);
+    std::cout << "population " << tuner.population() << ", " << config.games << " games of at most "
+              << config.maxPieces << " pieces each, " << pool.size() << " threads" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int g = 0; g < generations; ++g) {
+        auto generationStart = std::chrono::steady_clock::now();
+        TuneGeneration result = tuner.step(pool);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - generationStart).count();
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "gen " << std::setw(3) << result.generation
+                  << "  best " << std::setw(7) << result.bestFitness
+                  << "  cutoff " << std::setw(7) << result.cutoff
+                  << std::setprecision(3)
+                  << "  sigma " << result.sigma
+                  << "  games " << result.gamesPlayed
+                  << "  pruned " << result.candidatesPruned
+                  << "  " << seconds << " s" << std::endl;
+        std::cout << "    mean  ";
+        printWeights(result.mean);
+        std::cout << std::endl;
+
+        // Written every generation, so stopping early still leaves a result
+        if (!saveWeights(outPath, result.mean)) {
+            std::cerr << "Cannot write weights: " << outPath << std::endl;
+            return 1;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << std::setprecision(1) << "Weights written to " << outPath << " after " << seconds << " s" << std::endl;
+    return 0;
+}